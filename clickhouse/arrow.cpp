@@ -0,0 +1,899 @@
+#include "arrow.h"
+
+#include "columns/array.h"
+#include "columns/compute.h"
+#include "columns/date.h"
+#include "columns/decimal.h"
+#include "columns/lowcardinality.h"
+#include "columns/nullable.h"
+#include "columns/numeric.h"
+#include "columns/string.h"
+#include "columns/tuple.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace clickhouse {
+
+namespace {
+
+struct SchemaDeleter {
+    void operator()(ArrowSchema* schema) const {
+        if (schema->release) {
+            schema->release(schema);
+        }
+        delete schema;
+    }
+};
+
+struct ArrayDeleter {
+    void operator()(ArrowArray* array) const {
+        if (array->release) {
+            array->release(array);
+        }
+        delete array;
+    }
+};
+
+using SchemaPtr = std::unique_ptr<ArrowSchema, SchemaDeleter>;
+using ArrayPtr = std::unique_ptr<ArrowArray, ArrayDeleter>;
+
+/// Private data of an exported schema, children are released with it.
+struct SchemaData {
+    std::string format;
+    std::string name;
+    int64_t flags = 0;
+    std::vector<SchemaPtr> children;
+    std::vector<ArrowSchema*> child_pointers;
+    SchemaPtr dictionary;
+};
+
+/// Private data of an exported array, children are released with it.
+struct ArrayData {
+    int64_t length = 0;
+    int64_t null_count = 0;
+    /// Column, buffers of which are exported without copying.
+    ColumnRef column;
+    /// Buffers, which have been built for the export.
+    std::vector<std::unique_ptr<uint8_t[]>> own_buffers;
+    std::vector<const void*> buffers;
+    std::vector<ArrayPtr> children;
+    std::vector<ArrowArray*> child_pointers;
+    ArrayPtr dictionary;
+};
+
+struct ExportedColumn {
+    std::unique_ptr<SchemaData> schema = std::make_unique<SchemaData>();
+    std::unique_ptr<ArrayData> array = std::make_unique<ArrayData>();
+};
+
+/// Buffers of empty columns may be null, but consumers expect valid pointers.
+alignas(16) const uint8_t EMPTY_BUFFER[16] = {};
+
+const void* NonNull(const void* buffer) {
+    return buffer ? buffer : EMPTY_BUFFER;
+}
+
+template <typename T>
+T* Allocate(ArrayData& data, size_t count) {
+    data.own_buffers.emplace_back(new uint8_t[std::max<size_t>(count, 1) * sizeof(T)]);
+    return reinterpret_cast<T*>(data.own_buffers.back().get());
+}
+
+void ReleaseSchema(ArrowSchema* schema) {
+    delete static_cast<SchemaData*>(schema->private_data);
+    schema->release = nullptr;
+}
+
+void ReleaseArray(ArrowArray* array) {
+    delete static_cast<ArrayData*>(array->private_data);
+    array->release = nullptr;
+}
+
+/// Transfers ownership of the exported column to the structures.
+void Finish(ExportedColumn column, ArrowSchema* schema, ArrowArray* array) {
+    SchemaData* schema_data = column.schema.release();
+    ArrayData* array_data = column.array.release();
+
+    schema->format = schema_data->format.c_str();
+    schema->name = schema_data->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = schema_data->flags;
+    schema->n_children = static_cast<int64_t>(schema_data->child_pointers.size());
+    schema->children = schema_data->child_pointers.empty() ? nullptr : schema_data->child_pointers.data();
+    schema->dictionary = schema_data->dictionary.get();
+    schema->release = ReleaseSchema;
+    schema->private_data = schema_data;
+
+    array->length = array_data->length;
+    array->null_count = array_data->null_count;
+    array->offset = 0;
+    array->n_buffers = static_cast<int64_t>(array_data->buffers.size());
+    array->n_children = static_cast<int64_t>(array_data->child_pointers.size());
+    array->buffers = array_data->buffers.empty() ? nullptr : array_data->buffers.data();
+    array->children = array_data->child_pointers.empty() ? nullptr : array_data->child_pointers.data();
+    array->dictionary = array_data->dictionary.get();
+    array->release = ReleaseArray;
+    array->private_data = array_data;
+}
+
+void AddChild(ExportedColumn& parent, ExportedColumn child) {
+    SchemaPtr schema(new ArrowSchema{});
+    ArrayPtr array(new ArrowArray{});
+    Finish(std::move(child), schema.get(), array.get());
+
+    parent.schema->child_pointers.push_back(schema.get());
+    parent.schema->children.push_back(std::move(schema));
+    parent.array->child_pointers.push_back(array.get());
+    parent.array->children.push_back(std::move(array));
+}
+
+void SetDictionary(ExportedColumn& parent, ExportedColumn dictionary) {
+    parent.schema->dictionary.reset(new ArrowSchema{});
+    parent.array->dictionary.reset(new ArrowArray{});
+    Finish(std::move(dictionary), parent.schema->dictionary.get(), parent.array->dictionary.get());
+}
+
+/// Sets the validity bitmap of the exported column: bit is set for the rows, which are not null.
+void SetValidity(ExportedColumn& exported, const uint8_t* nulls, size_t size, size_t null_count) {
+    if (null_count == 0) {
+        return;
+    }
+
+    uint8_t* bitmap = Allocate<uint8_t>(*exported.array, (size + 7) / 8);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint8_t bits = 0;
+        for (size_t j = 0; j < 8; ++j) {
+            bits |= static_cast<uint8_t>((nulls[i + j] == 0) << j);
+        }
+        bitmap[i / 8] = bits;
+    }
+    if (i < size) {
+        uint8_t bits = 0;
+        for (size_t j = 0; i + j < size; ++j) {
+            bits |= static_cast<uint8_t>((nulls[i + j] == 0) << j);
+        }
+        bitmap[i / 8] = bits;
+    }
+
+    exported.array->buffers[0] = bitmap;
+    exported.array->null_count = static_cast<int64_t>(null_count);
+}
+
+ExportedColumn ExportColumn(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options);
+
+ExportedColumn MakeExported(const ColumnRef& column, const std::string& name, std::string format) {
+    ExportedColumn exported;
+    exported.schema->format = std::move(format);
+    exported.schema->name = name;
+    exported.array->length = static_cast<int64_t>(column->Size());
+    // No validity bitmap.
+    exported.array->buffers.push_back(nullptr);
+    return exported;
+}
+
+template <typename T>
+const ColumnVector<T>& AsVector(const ColumnRef& column) {
+    return dynamic_cast<const ColumnVector<T>&>(*column);
+}
+
+template <typename T>
+ExportedColumn ExportVector(const ColumnRef& column, const std::string& name, const char* format) {
+    auto exported = MakeExported(column, name, format);
+    exported.array->column = column;
+    exported.array->buffers.push_back(NonNull(AsVector<T>(column).GetData().data()));
+    return exported;
+}
+
+/// Converts values of the column into values of another type.
+template <typename Result, typename Values, typename Convert>
+ExportedColumn ExportConverted(const ColumnRef& column, const std::string& name, std::string format,
+                               const Values& values, Convert convert) {
+    auto exported = MakeExported(column, name, std::move(format));
+    Result* data = Allocate<Result>(*exported.array, values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        data[i] = convert(values[i]);
+    }
+    exported.array->buffers.push_back(data);
+    return exported;
+}
+
+ExportedColumn ExportString(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    const auto& strings = dynamic_cast<const ColumnString&>(*column);
+
+    // Chars and Int64 offsets of the column are the buffers of large binary (or utf8).
+    auto exported = MakeExported(column, name, options.string_as_utf8 ? "U" : "Z");
+    exported.array->column = column;
+    exported.array->buffers.push_back(strings.GetOffsets().data());
+    exported.array->buffers.push_back(NonNull(strings.GetChars().data()));
+    return exported;
+}
+
+ExportedColumn ExportFixedString(const ColumnRef& column, const std::string& name) {
+    const auto& strings = dynamic_cast<const ColumnFixedString&>(*column);
+
+    auto exported = MakeExported(column, name, "w:" + std::to_string(strings.FixedSize()));
+    exported.array->column = column;
+    // Values are stored one after another.
+    exported.array->buffers.push_back(NonNull(strings.Size() ? strings.At(0).data() : nullptr));
+    return exported;
+}
+
+ExportedColumn ExportDateTime64(const ColumnRef& column, const std::string& name) {
+    const auto& date_time = dynamic_cast<const ColumnDateTime64&>(*column);
+    const auto type = column->Type()->As<DateTime64Type>();
+    const size_t precision = type->GetPrecision();
+
+    // Values are scaled to the nearest unit of Arrow.
+    const char units[] = {'s', 'm', 'u', 'n'};
+    const size_t unit = std::min<size_t>((precision + 2) / 3, 3);
+    int64_t multiplier = 1;
+    for (size_t p = precision; p < unit * 3; ++p) {
+        multiplier *= 10;
+    }
+
+    auto exported = MakeExported(column, name, std::string("ts") + units[unit] + ":" + type->Timezone());
+    int64_t* data = Allocate<int64_t>(*exported.array, date_time.Size());
+    for (size_t i = 0; i < date_time.Size(); ++i) {
+        data[i] = date_time.At(i) * multiplier;
+    }
+    exported.array->buffers.push_back(data);
+    return exported;
+}
+
+ExportedColumn ExportDecimal(const ColumnRef& column, const std::string& name) {
+    const auto& decimal = dynamic_cast<const ColumnDecimal&>(*column);
+
+    auto exported = MakeExported(column, name,
+        "d:" + std::to_string(decimal.GetPrecision()) + "," + std::to_string(decimal.GetScale()));
+    // Decimal128 is stored as a little-endian 128-bit integer.
+    uint8_t* data = Allocate<uint8_t>(*exported.array, decimal.Size() * 16);
+    for (size_t i = 0; i < decimal.Size(); ++i) {
+        const Int128 value = decimal.At(i);
+        const uint64_t low = absl::Int128Low64(value);
+        const uint64_t high = static_cast<uint64_t>(absl::Int128High64(value));
+        std::memcpy(data + i * 16, &low, sizeof(low));
+        std::memcpy(data + i * 16 + 8, &high, sizeof(high));
+    }
+    exported.array->buffers.push_back(data);
+    return exported;
+}
+
+ExportedColumn ExportNullable(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    const auto& nullable = dynamic_cast<const ColumnNullable&>(*column);
+    const auto& nulls = AsVector<uint8_t>(nullable.Nulls()).GetData();
+
+    auto exported = ExportColumn(nullable.Nested(), name, options);
+    exported.schema->flags |= ARROW_FLAG_NULLABLE;
+    SetValidity(exported, nulls.data(), nulls.size(), nulls.size() - CountNonNull(nullable));
+    return exported;
+}
+
+template <typename Offset>
+void ExportOffsets(const std::vector<uint64_t>& ends, ExportedColumn& exported) {
+    Offset* offsets = Allocate<Offset>(*exported.array, ends.size() + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < ends.size(); ++i) {
+        offsets[i + 1] = static_cast<Offset>(ends[i]);
+    }
+    exported.array->buffers.push_back(offsets);
+}
+
+ExportedColumn ExportArray(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    const auto& array = dynamic_cast<const ColumnArray&>(*column);
+    const auto& ends = array.Offsets();
+
+    // Offsets of ClickHouse are ends of arrays, Arrow offsets start with zero.
+    const bool large = !ends.empty() && ends.back() > static_cast<uint64_t>(std::numeric_limits<int32_t>::max());
+
+    auto exported = MakeExported(column, name, large ? "+L" : "+l");
+    if (large) {
+        ExportOffsets<int64_t>(ends, exported);
+    } else {
+        ExportOffsets<int32_t>(ends, exported);
+    }
+    AddChild(exported, ExportColumn(array.Nested(), "item", options));
+    return exported;
+}
+
+ExportedColumn ExportTuple(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    const auto& tuple = dynamic_cast<const ColumnTuple&>(*column);
+
+    auto exported = MakeExported(column, name, "+s");
+    // Elements of tuples have no names, they are named by their positions, as in ClickHouse.
+    for (size_t i = 0; i < tuple.TupleSize(); ++i) {
+        AddChild(exported, ExportColumn(tuple[i], std::to_string(i + 1), options));
+    }
+    return exported;
+}
+
+template <typename T>
+ExportedColumn ExportIndices(const ColumnRef& indices, const std::string& name, const char* format, bool nullable) {
+    auto exported = ExportVector<T>(indices, name, format);
+    if (!nullable) {
+        return exported;
+    }
+
+    // Null item is the first one in the dictionary.
+    const auto& data = AsVector<T>(indices).GetData();
+    std::vector<uint8_t> nulls(data.size());
+    size_t null_count = 0;
+    for (size_t i = 0; i < data.size(); ++i) {
+        nulls[i] = data[i] == 0;
+        null_count += nulls[i];
+    }
+    exported.schema->flags |= ARROW_FLAG_NULLABLE;
+    SetValidity(exported, nulls.data(), nulls.size(), null_count);
+    return exported;
+}
+
+ExportedColumn ExportLowCardinality(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    const auto& lc = dynamic_cast<const ColumnLowCardinality&>(*column);
+
+    ColumnRef dictionary = lc.Dictionary();
+    const auto nullable_dictionary = dictionary->As<ColumnNullable>();
+    if (nullable_dictionary) {
+        dictionary = nullable_dictionary->Nested();
+    }
+
+    const auto indices = lc.Indices();
+    const bool nullable = nullable_dictionary != nullptr;
+
+    ExportedColumn exported;
+    switch (indices->Type()->GetCode()) {
+        case Type::UInt8:
+            exported = ExportIndices<uint8_t>(indices, name, "C", nullable);
+            break;
+        case Type::UInt16:
+            exported = ExportIndices<uint16_t>(indices, name, "S", nullable);
+            break;
+        case Type::UInt32:
+            exported = ExportIndices<uint32_t>(indices, name, "I", nullable);
+            break;
+        case Type::UInt64:
+            exported = ExportIndices<uint64_t>(indices, name, "L", nullable);
+            break;
+        default:
+            throw ValidationError("invalid index column type for LowCardinality column: " + indices->Type()->GetName());
+    }
+
+    SetDictionary(exported, ExportColumn(dictionary, std::string(), options));
+    return exported;
+}
+
+ExportedColumn ExportColumn(const ColumnRef& column, const std::string& name, const ArrowExportOptions& options) {
+    switch (column->Type()->GetCode()) {
+        case Type::Int8:
+            return ExportVector<int8_t>(column, name, "c");
+        case Type::Int16:
+            return ExportVector<int16_t>(column, name, "s");
+        case Type::Int32:
+            return ExportVector<int32_t>(column, name, "i");
+        case Type::Int64:
+            return ExportVector<int64_t>(column, name, "l");
+        case Type::UInt8:
+            return ExportVector<uint8_t>(column, name, "C");
+        case Type::UInt16:
+            return ExportVector<uint16_t>(column, name, "S");
+        case Type::UInt32:
+            return ExportVector<uint32_t>(column, name, "I");
+        case Type::UInt64:
+            return ExportVector<uint64_t>(column, name, "L");
+        case Type::Float32:
+            return ExportVector<float>(column, name, "f");
+        case Type::Float64:
+            return ExportVector<double>(column, name, "g");
+
+        case Type::String:
+            return ExportString(column, name, options);
+        case Type::FixedString:
+            return ExportFixedString(column, name);
+
+        case Type::Date:
+            return ExportConverted<int32_t>(column, name, "tdD", column->As<ColumnDate>()->GetRawData(),
+                [](uint16_t days) { return static_cast<int32_t>(days); });
+        case Type::Date32: {
+            auto exported = MakeExported(column, name, "tdD");
+            exported.array->column = column;
+            exported.array->buffers.push_back(NonNull(column->As<ColumnDate32>()->GetRawData().data()));
+            return exported;
+        }
+        case Type::DateTime:
+            return ExportConverted<int64_t>(column, name, "tss:" + column->Type()->As<DateTimeType>()->Timezone(),
+                column->As<ColumnDateTime>()->GetRawData(), [](uint32_t seconds) { return static_cast<int64_t>(seconds); });
+        case Type::DateTime64:
+            return ExportDateTime64(column, name);
+
+        case Type::Decimal:
+        case Type::Decimal32:
+        case Type::Decimal64:
+        case Type::Decimal128:
+            return ExportDecimal(column, name);
+
+        case Type::Nullable:
+            return ExportNullable(column, name, options);
+        case Type::Array:
+            return ExportArray(column, name, options);
+        case Type::Tuple:
+            return ExportTuple(column, name, options);
+        case Type::LowCardinality:
+            return ExportLowCardinality(column, name, options);
+
+        default:
+            throw UnimplementedError("can't export column of type " + column->Type()->GetName() + " to Arrow");
+    }
+}
+
+/// Releases imported structures, when the import is done.
+struct ImportGuard {
+    ArrowSchema* schema;
+    ArrowArray* array;
+
+    ~ImportGuard() {
+        if (array && array->release) {
+            array->release(array);
+        }
+        if (schema && schema->release) {
+            schema->release(schema);
+        }
+    }
+};
+
+template <typename T>
+const T* GetBuffer(const ArrowArray& array, size_t index) {
+    if (static_cast<int64_t>(index) >= array.n_buffers || (!array.buffers[index] && array.length > 0)) {
+        throw ValidationError("Arrow array has no buffer " + std::to_string(index));
+    }
+    return static_cast<const T*>(array.buffers[index]);
+}
+
+void CheckChildren(const ArrowSchema& schema, const ArrowArray& array) {
+    if (schema.n_children != array.n_children) {
+        throw ValidationError("Arrow array of format " + std::string(schema.format) + " has " + std::to_string(array.n_children) +
+            " children, schema has " + std::to_string(schema.n_children));
+    }
+}
+
+/// Bytes of every value of a byte of a bitmap, plain and inverted.
+using ExpandedByte = uint8_t[8];
+
+const ExpandedByte* GetExpansionTable(bool invert) {
+    static const auto tables = [] {
+        std::vector<uint8_t> result(2 * 256 * 8);
+        for (size_t value = 0; value < 256; ++value) {
+            for (size_t bit = 0; bit < 8; ++bit) {
+                const uint8_t is_set = (value >> bit) & 1;
+                result[value * 8 + bit] = is_set;
+                result[(256 + value) * 8 + bit] = is_set ^ 1;
+            }
+        }
+        return result;
+    }();
+    return reinterpret_cast<const ExpandedByte*>(tables.data() + (invert ? 256 * 8 : 0));
+}
+
+/// Expands bits [offset, offset + length) of the bitmap into bytes, eight bits at a time.
+void ExpandBits(const uint8_t* bitmap, size_t offset, size_t length, bool invert, uint8_t* result) {
+    const auto bit = [&](size_t i) {
+        return static_cast<uint8_t>(((bitmap[(offset + i) / 8] >> ((offset + i) % 8)) & 1) ^ invert);
+    };
+
+    size_t i = 0;
+    for (; i < length && (offset + i) % 8 != 0; ++i) {
+        result[i] = bit(i);
+    }
+
+    const ExpandedByte* table = GetExpansionTable(invert);
+    for (const uint8_t* byte = bitmap + (offset + i) / 8; i + 8 <= length; i += 8, ++byte) {
+        std::memcpy(result + i, table[*byte], 8);
+    }
+
+    for (; i < length; ++i) {
+        result[i] = bit(i);
+    }
+}
+
+/// Returns null map of rows, or empty vector if there are no nulls.
+std::vector<uint8_t> ImportNulls(const ArrowArray& array, size_t offset, size_t length) {
+    if (array.n_buffers == 0 || !array.buffers[0] || array.null_count == 0) {
+        return {};
+    }
+
+    std::vector<uint8_t> nulls(length);
+    ExpandBits(static_cast<const uint8_t*>(array.buffers[0]), offset, length, true, nulls.data());
+    if (std::find(nulls.begin(), nulls.end(), 1) == nulls.end()) {
+        return {};
+    }
+    return nulls;
+}
+
+ColumnRef ImportColumn(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length);
+
+template <typename T>
+ColumnRef ImportVector(const ArrowArray& array, size_t offset, size_t length) {
+    const T* data = GetBuffer<T>(array, 1) + offset;
+    return std::make_shared<ColumnVector<T>>(std::vector<T>(data, data + length));
+}
+
+ColumnRef ImportBooleans(const ArrowArray& array, size_t offset, size_t length) {
+    std::vector<uint8_t> values(length);
+    ExpandBits(GetBuffer<uint8_t>(array, 1), offset, length, false, values.data());
+    return std::make_shared<ColumnUInt8>(std::move(values));
+}
+
+template <typename Offset>
+ColumnRef ImportStrings(const ArrowArray& array, size_t offset, size_t length) {
+    const Offset* offsets = GetBuffer<Offset>(array, 1) + offset;
+    // Buffer of chars may be null, if all values are empty.
+    const char* chars = array.n_buffers > 2 && array.buffers[2] ? static_cast<const char*>(array.buffers[2]) : "";
+
+    const auto first = static_cast<uint64_t>(offsets[0]);
+    std::vector<uint64_t> column_offsets(length + 1);
+    for (size_t i = 0; i <= length; ++i) {
+        column_offsets[i] = static_cast<uint64_t>(offsets[i]) - first;
+    }
+    std::vector<char> column_chars(chars + first, chars + first + column_offsets.back());
+
+    return std::make_shared<ColumnString>(std::move(column_chars), std::move(column_offsets));
+}
+
+ColumnRef ImportFixedStrings(const ArrowArray& array, size_t offset, size_t length, const std::string& format) {
+    // w:bytewidth
+    size_t size = 0;
+    const char* const end = format.data() + format.size();
+    const auto [ptr, ec] = std::from_chars(format.data() + 2, end, size);
+    if (ec != std::errc() || ptr != end || size == 0) {
+        throw ValidationError("invalid format of Arrow fixed-size binary array: " + format);
+    }
+
+    const char* data = GetBuffer<char>(array, 1) + offset * size;
+
+    auto column = std::make_shared<ColumnFixedString>(size);
+    column->Reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        column->Append(std::string_view(data + i * size, size));
+    }
+    return column;
+}
+
+ColumnRef ImportTimestamps(const ArrowArray& array, size_t offset, size_t length, char unit, const std::string& timezone) {
+    const int64_t* data = GetBuffer<int64_t>(array, 1) + offset;
+
+    // Seconds beyond the range of DateTime are imported as DateTime64(0).
+    const auto fits_date_time = [](int64_t value) {
+        return value >= 0 && value <= static_cast<int64_t>(std::numeric_limits<uint32_t>::max());
+    };
+    if (unit == 's' && std::all_of(data, data + length, fits_date_time)) {
+        std::vector<uint32_t> seconds(length);
+        for (size_t i = 0; i < length; ++i) {
+            seconds[i] = static_cast<uint32_t>(data[i]);
+        }
+        return std::make_shared<ColumnDateTime>(timezone, std::move(seconds));
+    }
+
+    const size_t precision = unit == 's' ? 0 : unit == 'm' ? 3 : unit == 'u' ? 6 : 9;
+    auto column = std::make_shared<ColumnDateTime64>(precision, timezone);
+    column->Reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        column->Append(data[i]);
+    }
+    return column;
+}
+
+template <typename T>
+ColumnRef ImportDecimalValues(const uint8_t* data, size_t length, size_t precision, size_t scale) {
+    auto column = std::make_shared<ColumnDecimalT<T>>(precision, scale);
+    column->Reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        uint64_t low, high;
+        std::memcpy(&low, data + i * 16, sizeof(low));
+        std::memcpy(&high, data + i * 16 + 8, sizeof(high));
+        column->Append(static_cast<T>(absl::MakeInt128(static_cast<int64_t>(high), low)));
+    }
+    return column;
+}
+
+ColumnRef ImportDecimals(const ArrowArray& array, size_t offset, size_t length, const std::string& format) {
+    // d:precision,scale[,bitwidth]
+    size_t precision = 0, scale = 0, bit_width = 128;
+    if (std::sscanf(format.c_str(), "d:%zu,%zu,%zu", &precision, &scale, &bit_width) < 2 || bit_width != 128 || precision > 38) {
+        throw UnimplementedError("can't import Arrow array of format " + format);
+    }
+
+    // Values fit the storage of the precision, as columns created by type name.
+    const uint8_t* data = GetBuffer<uint8_t>(array, 1) + offset * 16;
+    if (precision <= 9) {
+        return ImportDecimalValues<int32_t>(data, length, precision, scale);
+    } else if (precision <= 18) {
+        return ImportDecimalValues<int64_t>(data, length, precision, scale);
+    }
+    return ImportDecimalValues<Int128>(data, length, precision, scale);
+}
+
+template <typename Offset>
+ColumnRef ImportList(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length) {
+    CheckChildren(schema, array);
+    if (array.n_children != 1) {
+        throw ValidationError("Arrow list array must have one child");
+    }
+
+    const Offset* offsets = GetBuffer<Offset>(array, 1) + offset;
+    const size_t begin = length ? static_cast<size_t>(offsets[0]) : 0;
+    const size_t end = length ? static_cast<size_t>(offsets[length]) : 0;
+    if (end < begin) {
+        throw ValidationError("Arrow list array has invalid offsets");
+    }
+
+    const ArrowArray& child = *array.children[0];
+    auto nested = ImportColumn(*schema.children[0], child, static_cast<size_t>(child.offset) + begin, end - begin);
+
+    // Offsets of ClickHouse are ends of arrays.
+    std::vector<uint64_t> ends(length);
+    for (size_t i = 0; i < length; ++i) {
+        ends[i] = static_cast<uint64_t>(offsets[i + 1]) - begin;
+    }
+    return std::make_shared<ColumnArray>(nested, std::make_shared<ColumnUInt64>(std::move(ends)));
+}
+
+ColumnRef ImportStruct(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length) {
+    CheckChildren(schema, array);
+
+    std::vector<ColumnRef> columns;
+    for (int64_t i = 0; i < array.n_children; ++i) {
+        // Offset of the struct applies to its children.
+        const ArrowArray& child = *array.children[i];
+        columns.push_back(ImportColumn(*schema.children[i], child, static_cast<size_t>(child.offset) + offset, length));
+    }
+    return std::make_shared<ColumnTuple>(columns);
+}
+
+ColumnRef ImportValues(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length) {
+    const std::string format = schema.format;
+
+    if (format.size() == 1) {
+        switch (format[0]) {
+            case 'c': return ImportVector<int8_t>(array, offset, length);
+            case 'C': return ImportVector<uint8_t>(array, offset, length);
+            case 's': return ImportVector<int16_t>(array, offset, length);
+            case 'S': return ImportVector<uint16_t>(array, offset, length);
+            case 'i': return ImportVector<int32_t>(array, offset, length);
+            case 'I': return ImportVector<uint32_t>(array, offset, length);
+            case 'l': return ImportVector<int64_t>(array, offset, length);
+            case 'L': return ImportVector<uint64_t>(array, offset, length);
+            case 'f': return ImportVector<float>(array, offset, length);
+            case 'g': return ImportVector<double>(array, offset, length);
+            case 'b': return ImportBooleans(array, offset, length);
+            case 'z':
+            case 'u': return ImportStrings<int32_t>(array, offset, length);
+            case 'Z':
+            case 'U': return ImportStrings<int64_t>(array, offset, length);
+        }
+    } else if (format == "tdD") {
+        const int32_t* data = GetBuffer<int32_t>(array, 1) + offset;
+        return std::make_shared<ColumnDate32>(std::vector<int32_t>(data, data + length));
+    } else if (format == "tdm") {
+        return ImportTimestamps(array, offset, length, 'm', std::string());
+    } else if (format.size() >= 4 && format.compare(0, 2, "ts") == 0 && format[3] == ':' &&
+               std::string_view("smun").find(format[2]) != std::string_view::npos) {
+        return ImportTimestamps(array, offset, length, format[2], format.substr(4));
+    } else if (format.compare(0, 2, "w:") == 0) {
+        return ImportFixedStrings(array, offset, length, format);
+    } else if (format.compare(0, 2, "d:") == 0) {
+        return ImportDecimals(array, offset, length, format);
+    } else if (format == "+l") {
+        return ImportList<int32_t>(schema, array, offset, length);
+    } else if (format == "+L") {
+        return ImportList<int64_t>(schema, array, offset, length);
+    } else if (format == "+s") {
+        return ImportStruct(schema, array, offset, length);
+    }
+
+    throw UnimplementedError("can't import Arrow array of format " + format);
+}
+
+template <typename T>
+void ImportIndices(const ArrowArray& array, size_t offset, size_t length, std::vector<size_t>& indices) {
+    const T* data = GetBuffer<T>(array, 1) + offset;
+    for (size_t i = 0; i < length; ++i) {
+        indices[i] = static_cast<size_t>(data[i]);
+    }
+}
+
+bool IsStringType(Type::Code code) {
+    return code == Type::String || code == Type::FixedString;
+}
+
+/// Adds the empty value to the end of a String or FixedString column.
+void AppendEmpty(Column& column) {
+    if (auto strings = dynamic_cast<ColumnString*>(&column)) {
+        strings->Append(std::string_view());
+    } else {
+        dynamic_cast<ColumnFixedString&>(column).Append(std::string_view());
+    }
+}
+
+ColumnRef ImportDictionary(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length,
+                           std::vector<uint8_t> nulls, bool nullable) {
+    if (!array.dictionary) {
+        throw ValidationError("Arrow array has no dictionary");
+    }
+
+    const ArrowArray& dictionary_array = *array.dictionary;
+    ColumnRef dictionary = ImportColumn(*schema.dictionary, dictionary_array,
+        static_cast<size_t>(dictionary_array.offset), static_cast<size_t>(dictionary_array.length));
+
+    // Nulls of the dictionary are nulls of rows, which refer to them.
+    std::vector<uint8_t> dictionary_nulls;
+    if (const auto nullable_dictionary = dictionary->As<ColumnNullable>()) {
+        dictionary_nulls = nullable_dictionary->Nulls()->As<ColumnUInt8>()->GetData();
+        dictionary = nullable_dictionary->Nested();
+    }
+
+    std::vector<size_t> indices(length);
+    const std::string format = schema.format;
+    if (format == "c") {
+        ImportIndices<int8_t>(array, offset, length, indices);
+    } else if (format == "C") {
+        ImportIndices<uint8_t>(array, offset, length, indices);
+    } else if (format == "s") {
+        ImportIndices<int16_t>(array, offset, length, indices);
+    } else if (format == "S") {
+        ImportIndices<uint16_t>(array, offset, length, indices);
+    } else if (format == "i") {
+        ImportIndices<int32_t>(array, offset, length, indices);
+    } else if (format == "I") {
+        ImportIndices<uint32_t>(array, offset, length, indices);
+    } else if (format == "l") {
+        ImportIndices<int64_t>(array, offset, length, indices);
+    } else if (format == "L") {
+        ImportIndices<uint64_t>(array, offset, length, indices);
+    } else {
+        throw ValidationError("invalid format of Arrow dictionary indices: " + format);
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (!nulls.empty() && nulls[i]) {
+            continue;
+        }
+        if (indices[i] >= dictionary->Size()) {
+            throw ValidationError("Arrow dictionary index " + std::to_string(indices[i]) + " is out of range");
+        }
+        if (!dictionary_nulls.empty() && dictionary_nulls[indices[i]]) {
+            if (nulls.empty()) {
+                nulls.assign(length, 0);
+            }
+            nulls[i] = 1;
+        }
+    }
+    nullable = nullable || !nulls.empty();
+
+    if (!IsStringType(dictionary->Type()->GetCode())) {
+        // Other types can't be inside LowCardinality.
+        if (!nulls.empty() && dictionary->Size() == 0) {
+            throw UnimplementedError("can't import Arrow dictionary of type " + dictionary->Type()->GetName() + " without values");
+        }
+        for (size_t i = 0; i < nulls.size(); ++i) {
+            if (nulls[i]) {
+                indices[i] = 0;
+            }
+        }
+
+        auto values = dictionary->Permute(indices);
+        if (!nullable) {
+            return values;
+        }
+        if (nulls.empty()) {
+            nulls.assign(length, 0);
+        }
+        return std::make_shared<ColumnNullable>(values, std::make_shared<ColumnUInt8>(std::move(nulls)));
+    }
+
+    // Every item of the dictionary becomes a row of the column, which is then permuted into rows of the array.
+    if (!nullable) {
+        return std::make_shared<ColumnLowCardinality>(dictionary)->Permute(indices);
+    }
+
+    // Null rows refer to the item after the dictionary.
+    auto items = dictionary->CloneEmpty();
+    items->Append(dictionary);
+    AppendEmpty(*items);
+    std::vector<uint8_t> item_nulls(items->Size(), 0);
+    item_nulls.back() = 1;
+
+    for (size_t i = 0; i < nulls.size(); ++i) {
+        if (nulls[i]) {
+            indices[i] = dictionary->Size();
+        }
+    }
+
+    return std::make_shared<ColumnLowCardinality>(
+        std::make_shared<ColumnNullable>(items, std::make_shared<ColumnUInt8>(std::move(item_nulls))))->Permute(indices);
+}
+
+ColumnRef ImportColumn(const ArrowSchema& schema, const ArrowArray& array, size_t offset, size_t length) {
+    if (!schema.format) {
+        throw ValidationError("Arrow schema has no format");
+    }
+    if (array.offset < 0 || array.length < 0 || offset + length > static_cast<size_t>(array.offset + array.length)) {
+        throw ValidationError("Arrow array of format " + std::string(schema.format) + " is shorter than expected");
+    }
+
+    auto nulls = ImportNulls(array, offset, length);
+    const bool nullable = (schema.flags & ARROW_FLAG_NULLABLE) || !nulls.empty();
+
+    if (schema.dictionary) {
+        return ImportDictionary(schema, array, offset, length, std::move(nulls), nullable);
+    }
+
+    auto values = ImportValues(schema, array, offset, length);
+
+    const auto code = values->Type()->GetCode();
+    if (code == Type::Array || code == Type::Tuple) {
+        if (!nulls.empty()) {
+            throw ValidationError("column of type " + values->Type()->GetName() + " can't have nulls");
+        }
+        return values;
+    }
+    if (!nullable) {
+        return values;
+    }
+
+    if (nulls.empty()) {
+        nulls.assign(length, 0);
+    }
+    return std::make_shared<ColumnNullable>(values, std::make_shared<ColumnUInt8>(std::move(nulls)));
+}
+
+}
+
+void ExportToArrow(const ColumnRef& column, const std::string& name, ArrowSchema* schema, ArrowArray* array,
+                   const ArrowExportOptions& options) {
+    Finish(ExportColumn(column, name, options), schema, array);
+}
+
+void ExportToArrow(const Block& block, ArrowSchema* schema, ArrowArray* array, const ArrowExportOptions& options) {
+    ExportedColumn exported;
+    exported.schema->format = "+s";
+    exported.array->length = static_cast<int64_t>(block.GetRowCount());
+    exported.array->buffers.push_back(nullptr);
+
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        AddChild(exported, ExportColumn(bi.Column(), bi.Name(), options));
+    }
+
+    Finish(std::move(exported), schema, array);
+}
+
+
+ColumnRef ImportColumnFromArrow(ArrowSchema* schema, ArrowArray* array) {
+    ImportGuard guard{schema, array};
+    return ImportColumn(*schema, *array, static_cast<size_t>(array->offset), static_cast<size_t>(array->length));
+}
+
+Block ImportBlockFromArrow(ArrowSchema* schema, ArrowArray* array) {
+    ImportGuard guard{schema, array};
+
+    if (!schema->format || std::string(schema->format) != "+s") {
+        throw ValidationError("Arrow array of a block must be a struct");
+    }
+    CheckChildren(*schema, *array);
+
+    const size_t rows = static_cast<size_t>(array->length);
+    Block block(static_cast<size_t>(array->n_children), rows);
+    for (int64_t i = 0; i < array->n_children; ++i) {
+        const ArrowArray& child = *array->children[i];
+        const ArrowSchema& field = *schema->children[i];
+        block.AppendColumn(field.name ? field.name : "",
+            ImportColumn(field, child, static_cast<size_t>(child.offset + array->offset), rows));
+    }
+    return block;
+}
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "block.h"
+
+#include <cstdint>
+#include <string>
+
+/// Structures of the Arrow C data interface, as defined by
+/// https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace clickhouse {
+
+struct ArrowExportOptions {
+    /// Export String columns as utf8 instead of binary, values are not validated.
+    bool string_as_utf8 = false;
+};
+
+/**
+ * Exports the column into structures of the Arrow C data interface.
+ *
+ * Buffers of numeric, String, FixedString and Date32 columns and indices of LowCardinality
+ * columns are exported without copying: the array keeps a reference to the column,
+ * which must not be modified until the array is released. String is exported as
+ * large binary (or utf8), which has Int64 offsets as the column. Other columns are converted:
+ *  - Date, DateTime and DateTime64 into date32 and timestamp;
+ *  - Decimal into decimal128;
+ *  - null map of Nullable into the validity bitmap;
+ *  - Array and Tuple into list and struct;
+ *  - LowCardinality into dictionary-encoded array.
+ *
+ * Structures are released by the consumer with their release callbacks.
+ */
+void ExportToArrow(const ColumnRef& column, const std::string& name, ArrowSchema* schema, ArrowArray* array,
+                   const ArrowExportOptions& options = ArrowExportOptions());
+
+/// Exports the block as a struct array, children of which are columns of the block,
+/// as a record batch is exported.
+void ExportToArrow(const Block& block, ArrowSchema* schema, ArrowArray* array,
+                   const ArrowExportOptions& options = ArrowExportOptions());
+
+/**
+ * Creates column from structures of the Arrow C data interface.
+ *
+ * Types are mapped to the closest ones of ClickHouse:
+ *  - integer, floating-point and boolean into numeric columns;
+ *  - binary and utf8 into String, fixed-size binary into FixedString;
+ *  - date32 into Date32, timestamp[s] into DateTime (DateTime64(0) if values exceed its range),
+ *    other timestamps into DateTime64;
+ *  - decimal128 into Decimal;
+ *  - list and struct into Array and Tuple;
+ *  - dictionary-encoded String and FixedString into LowCardinality,
+ *    dictionaries of other types are decoded.
+ * Nullable fields and arrays with nulls become Nullable columns.
+ *
+ * Schema and array are released, even if the import fails.
+ */
+ColumnRef ImportColumnFromArrow(ArrowSchema* schema, ArrowArray* array);
+
+/// Creates block from a struct array, as a record batch is exported: children of the array
+/// become columns of the block, named by the fields of the schema.
+Block ImportBlockFromArrow(ArrowSchema* schema, ArrowArray* array);
+
+}
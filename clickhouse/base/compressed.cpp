@@ -20,7 +20,13 @@ constexpr size_t DBMS_MAX_COMPRESSED_SIZE = 0x40000000ULL;   // 1GB
 namespace clickhouse {
 
 CompressedInput::CompressedInput(InputStream* input)
+    : CompressedInput(input, nullptr)
+{
+}
+
+CompressedInput::CompressedInput(InputStream* input, CompressedFrames* raw_frames)
     : input_(input)
+    , raw_frames_(raw_frames)
 {
 }
 
@@ -46,6 +52,17 @@ size_t CompressedInput::DoNext(const void** ptr, size_t len) {
     return mem_.Next(ptr, len);
 }
 
+size_t CompressedInput::DoPeek(const void** ptr) {
+    if (mem_.Exhausted()) {
+        if (!Decompress()) {
+            *ptr = nullptr;
+            return 0;
+        }
+    }
+
+    return mem_.Peek(ptr);
+}
+
 bool CompressedInput::Decompress() {
     uint128 hash;
     uint32_t compressed = 0;
@@ -92,6 +109,15 @@ bool CompressedInput::Decompress() {
             }
         }
 
+        if (raw_frames_) {
+            auto& raw = raw_frames_->data;
+            raw_frames_->headers.push_back(CompressedFrameHeader{raw.size(), method, compressed, original});
+
+            const auto hash_bytes = reinterpret_cast<const uint8_t*>(&hash);
+            raw.insert(raw.end(), hash_bytes, hash_bytes + sizeof(hash));
+            raw.insert(raw.end(), tmp.begin(), tmp.end());
+        }
+
         data_ = Buffer(original);
 
         if (LZ4_decompress_safe((const char*)tmp.data() + HEADER_SIZE, (char*)data_.data(), compressed - HEADER_SIZE, original) < 0) {
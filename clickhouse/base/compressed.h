@@ -4,20 +4,44 @@
 #include "output.h"
 #include "buffer.h"
 
+#include <vector>
+
 namespace clickhouse {
 
+/// Header of a compressed frame.
+struct CompressedFrameHeader {
+    /// Position of the frame in CompressedFrames::data.
+    size_t   offset = 0;
+    uint8_t  method = 0;
+    /// Size of the frame without checksum: header and compressed data.
+    uint32_t compressed_size = 0;
+    /// Size of the data after decompression.
+    uint32_t original_size = 0;
+};
+
+/// Compressed frames as they are sent over the wire, one after another:
+/// 16 bytes of checksum, 9 bytes of header and compressed data.
+struct CompressedFrames {
+    Buffer data;
+    std::vector<CompressedFrameHeader> headers;
+};
+
 class CompressedInput : public ZeroCopyInput {
 public:
     explicit CompressedInput(InputStream* input);
+    /// Every frame read from input is also appended, as is, to `raw_frames`.
+    CompressedInput(InputStream* input, CompressedFrames* raw_frames);
     ~CompressedInput() override;
 
 protected:
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
 
     bool Decompress();
 
 private:
     InputStream* const input_;
+    CompressedFrames* const raw_frames_;
 
     Buffer data_;
     ArrayInput mem_;
@@ -0,0 +1,69 @@
+#include "file.h"
+#include "platform.h"
+
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#if defined(_unix_)
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace clickhouse {
+
+MappedFile::MappedFile(const std::string& path) {
+#if defined(_unix_)
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::system_category(), "can't open file " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        const int err = errno;
+        ::close(fd_);
+        throw std::system_error(err, std::system_category(), "can't stat file " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    // Zero-length mappings are not allowed.
+    if (size_ > 0) {
+        void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (ptr == MAP_FAILED) {
+            const int err = errno;
+            ::close(fd_);
+            throw std::system_error(err, std::system_category(), "can't map file " + path);
+        }
+        ::madvise(ptr, size_, MADV_SEQUENTIAL);
+
+        data_ = static_cast<const uint8_t*>(ptr);
+        mapped_ = true;
+    }
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "can't open file " + path);
+    }
+
+    buffer_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if defined(_unix_)
+    if (mapped_) {
+        ::munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace clickhouse {
+
+/// Read-only file mapped into memory.
+/// On platforms without mmap() the content is read into memory instead.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    inline const uint8_t* Data() const noexcept {
+        return data_;
+    }
+
+    inline size_t Size() const noexcept {
+        return size_;
+    }
+
+    /// Descriptor of the open file, e.g. for sending it with sendfile(), -1 if not available.
+    inline int Descriptor() const noexcept {
+        return fd_;
+    }
+
+private:
+    int fd_ = -1;
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    Buffer buffer_;
+};
+
+}
@@ -20,6 +20,11 @@ bool ZeroCopyInput::Skip(size_t bytes) {
     return true;
 }
 
+size_t ZeroCopyInput::DoPeek(const void** ptr) {
+    *ptr = nullptr;
+    return 0;
+}
+
 size_t ZeroCopyInput::DoRead(void* buf, size_t len) {
     const void* ptr;
     size_t result = DoNext(&ptr, len);
@@ -55,6 +60,11 @@ size_t ArrayInput::DoNext(const void** ptr, size_t len) {
     return len;
 }
 
+size_t ArrayInput::DoPeek(const void** ptr) {
+    *ptr = data_;
+    return len_;
+}
+
 
 BufferedInput::BufferedInput(std::unique_ptr<InputStream> source, size_t buflen)
     : source_(std::move(source))
@@ -79,6 +89,16 @@ size_t BufferedInput::DoNext(const void** ptr, size_t len)  {
     return array_input_.Next(ptr, len);
 }
 
+size_t BufferedInput::DoPeek(const void** ptr) {
+    if (array_input_.Exhausted()) {
+        array_input_.Reset(
+            buffer_.data(), source_->Read(buffer_.data(), buffer_.size())
+        );
+    }
+
+    return array_input_.Peek(ptr);
+}
+
 size_t BufferedInput::DoRead(void* buf, size_t len) {
     if (array_input_.Exhausted()) {
         if (len > buffer_.size() / 2) {
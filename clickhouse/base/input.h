@@ -36,11 +36,19 @@ public:
         return DoNext(buf, len);
     }
 
+    /// Returns data available in the current window, without consuming it.
+    /// Data is consumed by Next() or Skip(). Streams, which can't look ahead, return 0.
+    inline size_t Peek(const void** buf) {
+        return DoPeek(buf);
+    }
+
     bool Skip(size_t bytes) override;
 
 protected:
     virtual size_t DoNext(const void** ptr, size_t len) = 0;
 
+    virtual size_t DoPeek(const void** ptr);
+
     size_t DoRead(void* buf, size_t len) override;
 };
 
@@ -76,6 +84,7 @@ public:
 
 private:
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
 
 private:
     const uint8_t* data_;
@@ -90,9 +99,15 @@ public:
 
     void Reset();
 
+    /// Whether some data has already been read from the source but not consumed yet.
+    inline bool HasBufferedData() const noexcept {
+        return !array_input_.Exhausted();
+    }
+
 protected:
     size_t DoRead(void* buf, size_t len) override;
     size_t DoNext(const void** ptr, size_t len) override;
+    size_t DoPeek(const void** ptr) override;
 
 private:
     std::unique_ptr<InputStream> const source_;
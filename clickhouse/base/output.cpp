@@ -89,12 +89,13 @@ void BufferedOutput::DoFlush() {
 }
 
 size_t BufferedOutput::DoNext(void** data, size_t len) {
-    if (array_output_.Avail() < len) {
+    // Rest of the buffer is returned, even if it is shorter than requested:
+    // the buffer is flushed only when it is full.
+    if (array_output_.Exhausted()) {
         Flush();
     }
 
     return array_output_.Next(data, len);
-
 }
 
 size_t BufferedOutput::DoWrite(const void* data, size_t len) {
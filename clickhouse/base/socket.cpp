@@ -2,6 +2,7 @@
 #include "singleton.h"
 #include "../client.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <stdexcept>
 #include <system_error>
@@ -18,6 +19,10 @@
 #   include <unistd.h>
 #endif
 
+#if defined(_linux_)
+#   include <sys/sendfile.h>
+#endif
+
 namespace clickhouse {
 
 #if defined(_win_)
@@ -280,6 +285,14 @@ const std::string & NetworkAddress::Host() const {
 
 SocketBase::~SocketBase() = default;
 
+bool SocketBase::waitForRead(std::chrono::milliseconds) const {
+    return true;
+}
+
+bool SocketBase::sendFile(int, uint64_t, size_t) const {
+    return false;
+}
+
 
 SocketFactory::~SocketFactory() = default;
 
@@ -359,6 +372,53 @@ std::unique_ptr<OutputStream> Socket::makeOutputStream() const {
     return std::make_unique<SocketOutput>(handle_);
 }
 
+bool Socket::waitForRead(std::chrono::milliseconds timeout) const {
+    pollfd fd;
+    fd.fd = handle_;
+    fd.events = POLLIN;
+    fd.revents = 0;
+
+    const ssize_t rval = Poll(&fd, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(timeout.count(), 0)));
+
+    if (rval == -1) {
+        throw std::system_error(getSocketErrorCode(), getErrorCategory(), "fail to poll socket");
+    }
+
+    // Errors and hang ups are reported as readable, so the following read fails with a proper error.
+    return rval > 0;
+}
+
+bool Socket::sendFile(int fd, uint64_t offset, size_t len) const {
+#if defined(_linux_)
+    off_t pos = static_cast<off_t>(offset);
+
+    while (len > 0) {
+        const ssize_t ret = ::sendfile(handle_, fd, &pos, len);
+
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            throw std::system_error(getSocketErrorCode(), getErrorCategory(), "fail to send " + std::to_string(len) + " bytes of file data");
+        }
+        // The file has been shortened while being sent, errno isn't set in this case.
+        if (ret == 0) {
+            throw std::system_error(std::make_error_code(std::errc::io_error),
+                "unexpected end of file, " + std::to_string(len) + " bytes of file data are not sent");
+        }
+
+        len -= static_cast<size_t>(ret);
+    }
+
+    return true;
+#else
+    (void)fd;
+    (void)offset;
+    (void)len;
+    return false;
+#endif
+}
+
 
 NonSecureSocketFactory::~NonSecureSocketFactory()  {}
 
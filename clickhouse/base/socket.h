@@ -67,6 +67,14 @@ public:
 
     virtual std::unique_ptr<InputStream> makeInputStream() const = 0;
     virtual std::unique_ptr<OutputStream> makeOutputStream() const = 0;
+
+    /// Wait until there is data available for reading or timeout expires.
+    /// Returns false on timeout. Sockets that can't wait always report data as available.
+    virtual bool waitForRead(std::chrono::milliseconds timeout) const;
+
+    /// Send `len` bytes of file `fd` starting from `offset` without copying them to user space.
+    /// Returns false, without sending anything, if it is not supported by the socket.
+    virtual bool sendFile(int fd, uint64_t offset, size_t len) const;
 };
 
 
@@ -109,6 +117,9 @@ public:
     std::unique_ptr<InputStream> makeInputStream() const override;
     std::unique_ptr<OutputStream> makeOutputStream() const override;
 
+    bool waitForRead(std::chrono::milliseconds timeout) const override;
+    bool sendFile(int fd, uint64_t offset, size_t len) const override;
+
 protected:
     Socket(const Socket&) = delete;
     Socket& operator = (const Socket&) = delete;
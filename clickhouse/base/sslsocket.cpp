@@ -280,6 +280,19 @@ std::unique_ptr<OutputStream> SSLSocket::makeOutputStream() const {
     return std::make_unique<SSLSocketOutput>(ssl_.get());
 }
 
+bool SSLSocket::waitForRead(std::chrono::milliseconds timeout) const {
+    // Decrypted data buffered by OpenSSL is invisible to poll().
+    if (SSL_pending(ssl_.get()) > 0)
+        return true;
+
+    return Socket::waitForRead(timeout);
+}
+
+bool SSLSocket::sendFile(int, uint64_t, size_t) const {
+    // Data must be encrypted, so it can't bypass user space.
+    return false;
+}
+
 SSLSocketInput::SSLSocketInput(SSL *ssl)
     : ssl_(ssl)
 {}
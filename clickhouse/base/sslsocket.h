@@ -60,6 +60,9 @@ public:
     std::unique_ptr<InputStream> makeInputStream() const override;
     std::unique_ptr<OutputStream> makeOutputStream() const override;
 
+    bool waitForRead(std::chrono::milliseconds timeout) const override;
+    bool sendFile(int fd, uint64_t offset, size_t len) const override;
+
     static void validateParams(const SSLParams & ssl_params);
 private:
     std::unique_ptr<SSL, void (*)(SSL *s)> ssl_;
@@ -1,11 +1,157 @@
 #include "block.h"
 
 #include "exceptions.h"
+#include "columns/numeric.h"
 
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <stdexcept>
+#include <string_view>
+#include <type_traits>
 
 namespace clickhouse {
 
+namespace {
+
+/// Bytes of the key, which are sorted with one pass of radix sort.
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_SIZE = size_t(1) << RADIX_BITS;
+
+/**
+ * Sorts the permutation by unsigned keys of rows with LSD radix sort.
+ * Sort is stable, so keys of the more significant columns are sorted later.
+ * Passes are skipped when all keys have the same digit.
+ */
+void RadixSortPermutation(const std::vector<uint64_t>& keys, size_t key_size, std::vector<size_t>& permutation) {
+    const size_t rows = permutation.size();
+
+    std::vector<size_t> counts(key_size * RADIX_SIZE, 0);
+    for (const auto key : keys) {
+        for (size_t pass = 0; pass < key_size; ++pass) {
+            ++counts[pass * RADIX_SIZE + ((key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1))];
+        }
+    }
+
+    std::vector<size_t> buffer(rows);
+    for (size_t pass = 0; pass < key_size; ++pass) {
+        size_t* count = counts.data() + pass * RADIX_SIZE;
+        if (std::find(count, count + RADIX_SIZE, rows) != count + RADIX_SIZE) {
+            continue;
+        }
+
+        // Counts become positions of the first row of every digit.
+        size_t position = 0;
+        for (size_t digit = 0; digit < RADIX_SIZE; ++digit) {
+            const size_t n = count[digit];
+            count[digit] = position;
+            position += n;
+        }
+
+        for (const auto row : permutation) {
+            buffer[count[(keys[row] >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)]++] = row;
+        }
+        permutation.swap(buffer);
+    }
+}
+
+/// Keys of signed integers are flipped in the sign bit, so they are ordered as unsigned ones.
+template <typename T>
+bool TryGetIntegerKeys(const Column& column, std::vector<uint64_t>& keys, size_t* key_size) {
+    const auto col = dynamic_cast<const ColumnVector<T>*>(&column);
+    if (!col) {
+        return false;
+    }
+
+    using UnsignedT = std::make_unsigned_t<T>;
+    constexpr UnsignedT sign = std::is_signed_v<T> ? UnsignedT(1) << (sizeof(T) * 8 - 1) : 0;
+
+    const auto& data = col->GetData();
+    for (size_t i = 0; i < data.size(); ++i) {
+        keys[i] = static_cast<UnsignedT>(static_cast<UnsignedT>(data[i]) ^ sign);
+    }
+    *key_size = sizeof(T);
+    return true;
+}
+
+/// Integer types, which are stored in columns of other kinds.
+bool IsSignedInteger(Type::Code code) {
+    return code == Type::Enum8 || code == Type::Enum16 || code == Type::Date32 || code == Type::DateTime64;
+}
+
+bool IsUnsignedInteger(Type::Code code) {
+    return code == Type::Date || code == Type::DateTime || code == Type::IPv4;
+}
+
+bool IsString(const Type& type) {
+    switch (type.GetCode()) {
+        case Type::String:
+        case Type::FixedString:
+            return true;
+        case Type::LowCardinality:
+            return IsString(*type.As<LowCardinalityType>()->GetNestedType());
+        default:
+            return false;
+    }
+}
+
+/// Returns false if the column can't be sorted with radix sort.
+bool GetRadixKeys(const Column& column, std::vector<uint64_t>& keys, size_t* key_size) {
+    if (TryGetIntegerKeys<uint8_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<uint16_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<uint32_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<uint64_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<int8_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<int16_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<int32_t>(column, keys, key_size) ||
+        TryGetIntegerKeys<int64_t>(column, keys, key_size)) {
+        return true;
+    }
+
+    const auto code = column.Type()->GetCode();
+    if (!IsSignedInteger(code) && !IsUnsignedInteger(code)) {
+        return false;
+    }
+
+    *key_size = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const auto data = column.GetItem(i).data;
+        if (data.empty() || data.size() > sizeof(uint64_t)) {
+            return false;
+        }
+
+        uint64_t key = 0;
+        std::memcpy(&key, data.data(), data.size());
+        if (IsSignedInteger(code)) {
+            key ^= uint64_t(1) << (data.size() * 8 - 1);
+        }
+        keys[i] = key;
+        *key_size = data.size();
+    }
+    return true;
+}
+
+void SortPermutation(const Column& column, std::vector<size_t>& permutation) {
+    std::vector<uint64_t> keys(permutation.size());
+    size_t key_size = 0;
+
+    if (GetRadixKeys(column, keys, &key_size)) {
+        RadixSortPermutation(keys, key_size, permutation);
+    } else if (IsString(*column.Type())) {
+        std::vector<std::string_view> values(permutation.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = column.GetItem(i).data;
+        }
+        std::stable_sort(permutation.begin(), permutation.end(), [&values](size_t a, size_t b) {
+            return values[a] < values[b];
+        });
+    } else {
+        throw ValidationError("unsupported type of sort key: " + column.Type()->GetName());
+    }
+}
+
+}
+
 Block::Iterator::Iterator(const Block& block)
     : block_(block)
     , idx_(0)
@@ -100,6 +246,31 @@ size_t Block::RefreshRowCount()
     return rows_;
 }
 
+void Block::SortBy(const std::vector<std::string>& column_names) {
+    std::vector<ColumnRef> keys;
+    for (const auto& name : column_names) {
+        const auto it = std::find_if(columns_.begin(), columns_.end(), [&name](const ColumnItem& item) {
+            return item.name == name;
+        });
+        if (it == columns_.end()) {
+            throw ValidationError("block has no sort key column '" + name + "'");
+        }
+        keys.push_back(it->column);
+    }
+
+    std::vector<size_t> permutation(rows_);
+    std::iota(permutation.begin(), permutation.end(), size_t(0));
+
+    // The least significant key is sorted first.
+    for (auto key = keys.rbegin(); key != keys.rend(); ++key) {
+        SortPermutation(**key, permutation);
+    }
+
+    for (auto& item : columns_) {
+        item.column = item.column->Permute(permutation);
+    }
+}
+
 ColumnRef Block::operator [] (size_t idx) const {
     if (idx < columns_.size()) {
         return columns_[idx].column;
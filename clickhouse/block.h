@@ -81,6 +81,12 @@ public:
 
     size_t RefreshRowCount();
 
+    /// Sorts rows of the block in ascending order of the given columns, the first
+    /// column is the most significant. Rows with equal keys keep their order.
+    /// Integer, Date/DateTime and Enum keys are sorted with radix sort,
+    /// String, FixedString and LowCardinality of them with comparison sort.
+    void SortBy(const std::vector<std::string>& column_names);
+
     const std::string& GetColumnName(size_t idx) const {
         return columns_.at(idx).name;
     }
@@ -1,7 +1,10 @@
 #include "client.h"
+#include "native_format.h"
 #include "protocol.h"
+#include "revision.h"
 
 #include "base/compressed.h"
+#include "base/file.h"
 #include "base/socket.h"
 #include "base/wire_format.h"
 
@@ -9,6 +12,7 @@
 
 #include <assert.h>
 #include <atomic>
+#include <chrono>
 #include <system_error>
 #include <thread>
 #include <vector>
@@ -23,28 +27,6 @@
 #define DBMS_VERSION_MAJOR                              2
 #define DBMS_VERSION_MINOR                              1
 
-#define DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES         50264
-#define DBMS_MIN_REVISION_WITH_TOTAL_ROWS_IN_PROGRESS   51554
-#define DBMS_MIN_REVISION_WITH_BLOCK_INFO               51903
-#define DBMS_MIN_REVISION_WITH_CLIENT_INFO              54032
-#define DBMS_MIN_REVISION_WITH_SERVER_TIMEZONE          54058
-#define DBMS_MIN_REVISION_WITH_QUOTA_KEY_IN_CLIENT_INFO 54060
-//#define DBMS_MIN_REVISION_WITH_TABLES_STATUS            54226
-#define DBMS_MIN_REVISION_WITH_TIME_ZONE_PARAMETER_IN_DATETIME_DATA_TYPE 54337
-#define DBMS_MIN_REVISION_WITH_SERVER_DISPLAY_NAME      54372
-#define DBMS_MIN_REVISION_WITH_VERSION_PATCH            54401
-#define DBMS_MIN_REVISION_WITH_LOW_CARDINALITY_TYPE     54405
-#define DBMS_MIN_REVISION_WITH_COLUMN_DEFAULTS_METADATA 54410
-#define DBMS_MIN_REVISION_WITH_CLIENT_WRITE_INFO        54420
-#define DBMS_MIN_REVISION_WITH_SETTINGS_SERIALIZED_AS_STRINGS 54429
-#define DBMS_MIN_REVISION_WITH_INTERSERVER_SECRET       54441
-#define DBMS_MIN_REVISION_WITH_OPENTELEMETRY            54442
-#define DBMS_MIN_REVISION_WITH_DISTRIBUTED_DEPTH        54448
-#define DBMS_MIN_REVISION_WITH_INITIAL_QUERY_START_TIME 54449
-#define DBMS_MIN_REVISION_WITH_INCREMENTAL_PROFILE_EVENTS 54451
-
-#define REVISION  DBMS_MIN_REVISION_WITH_INCREMENTAL_PROFILE_EVENTS
-
 namespace clickhouse {
 
 struct ClientInfo {
@@ -111,6 +93,84 @@ std::unique_ptr<SocketFactory> GetSocketFactory(const ClientOptions& opts) {
         return std::make_unique<NonSecureSocketFactory>();
 }
 
+/// Collects columns of all blocks received for a query and glues them together
+/// when the query is finished and exact count of rows is known.
+class BlockAccumulator {
+public:
+    void Add(const Block& block) {
+        if (columns_.empty()) {
+            // The very first block (usually an empty one) defines structure of the result.
+            for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+                columns_.push_back(ColumnParts{bi.Name(), {bi.Column()}});
+            }
+            rows_ = block.GetRowCount();
+            return;
+        }
+
+        if (block.GetRowCount() == 0) {
+            return;
+        }
+        if (block.GetColumnCount() != columns_.size()) {
+            throw ProtocolError("unexpected number of columns in block: " + std::to_string(block.GetColumnCount())
+                    + ", expected: " + std::to_string(columns_.size()));
+        }
+
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            columns_[i].parts.push_back(block[i]);
+        }
+        rows_ += block.GetRowCount();
+    }
+
+    Block Release() {
+        Block result(columns_.size(), rows_);
+
+        for (auto& column : columns_) {
+            result.AppendColumn(column.name, Concatenate(column.parts));
+            // Release source parts as soon as possible to keep peak memory usage low.
+            column.parts.clear();
+        }
+
+        columns_.clear();
+        rows_ = 0;
+
+        return result;
+    }
+
+private:
+    struct ColumnParts {
+        std::string name;
+        std::vector<ColumnRef> parts;
+    };
+
+    ColumnRef Concatenate(const std::vector<ColumnRef>& parts) const {
+        size_t non_empty_parts = 0;
+        ColumnRef last_non_empty = parts.front();
+        for (const auto& part : parts) {
+            if (part->Size()) {
+                last_non_empty = part;
+                ++non_empty_parts;
+            }
+        }
+
+        if (non_empty_parts <= 1) {
+            // All rows came in a single block, nothing to copy.
+            return last_non_empty;
+        }
+
+        auto result = parts.front()->CloneEmpty();
+        result->Reserve(rows_);
+        for (const auto& part : parts) {
+            result->Append(part);
+        }
+
+        return result;
+    }
+
+private:
+    std::vector<ColumnParts> columns_;
+    size_t rows_ = 0;
+};
+
 }
 
 class Client::Impl {
@@ -122,10 +182,14 @@ public:
 
     void ExecuteQuery(Query query);
 
+    void SelectRaw(Query query, SelectRawCallback cb);
+
     void SendCancel();
 
     void Insert(const std::string& table_name, const std::string& query_id, const Block& block);
 
+    void InsertNativeFile(const std::string& table_name, const std::string& query_id, const std::string& path);
+
     void Ping();
 
     void ResetConnection();
@@ -137,12 +201,43 @@ private:
 
     bool ReceivePacket(uint64_t* server_packet = nullptr);
 
+    /// Sends INSERT query for columns of `structure` and waits for the server to ask for data.
+    void BeginInsert(const std::string& table_name, const std::string& query_id, const Block& structure);
+
+    /// Sends end of data marker and waits for the end of the INSERT query.
+    void EndInsert();
+
+    /// Finds blocks in a native file and checks they all have the same structure, which is stored to `structure`.
+    /// Returns offset and size of each block.
+    std::vector<std::pair<size_t, size_t>> ScanNativeFile(const MappedFile& file, const std::string& path, Block* structure);
+
+    /// Handles packet, which type has already been read from input stream.
+    bool ProcessPacket(uint64_t packet_type);
+
+    /// Receives query result, cancels the query if it is not completed before the deadline.
+    void ReceiveUntil(std::chrono::steady_clock::time_point deadline, QueryCancelPolicy policy);
+
+    /// Waits for the server to acknowledge cancellation without reading any data,
+    /// resets the connection if it doesn't happen in time.
+    void AbortQuery();
+
+    /// Returns false if there is no packet to read before the deadline.
+    bool WaitForPacket(std::chrono::steady_clock::time_point deadline) const;
+
     void SendQuery(const Query& query);
 
-    void SendData(const Block& block);
+    void SendData(const Block& block, const std::string& table_name = std::string());
 
     bool SendHello();
 
+    void SendAddendum();
+
+    /// Settings of block serialization for the current connection.
+    NativeFormatSettings GetNativeFormatSettings() const;
+
+    /// Settings of block serialization in native files, which are written at NATIVE_FILE_REVISION.
+    NativeFormatSettings GetNativeFileFormatSettings() const;
+
     bool ReadBlock(InputStream& input, Block* block);
 
     bool ReceiveHello();
@@ -163,9 +258,10 @@ private:
     void RetryGuard(std::function<void()> func);
 
 private:
+    template <typename T>
     class EnsureNull {
     public:
-        inline EnsureNull(QueryEvents* ev, QueryEvents** ptr)
+        inline EnsureNull(T* ev, T** ptr)
             : ptr_(ptr)
         {
             if (ptr_) {
@@ -180,18 +276,22 @@ private:
         }
 
     private:
-        QueryEvents** ptr_;
+        T** ptr_;
 
     };
 
 
     const ClientOptions options_;
     QueryEvents* events_;
+    SelectRawCallback raw_data_cb_;
+    /// Structure of the table, which is received in reply to INSERT query,
+    /// while columns are dictionary-encoded for it.
+    Block* insert_structure_ = nullptr;
     int compression_ = CompressionState::Disable;
 
     std::unique_ptr<SocketFactory> socket_factory_;
 
-    std::unique_ptr<InputStream> input_;
+    std::unique_ptr<BufferedInput> input_;
     std::unique_ptr<OutputStream> output_;
     std::unique_ptr<SocketBase> socket_;
 
@@ -236,13 +336,102 @@ void Client::Impl::ExecuteQuery(Query query) {
         RetryGuard([this]() { Ping(); });
     }
 
+    const auto deadline = std::chrono::steady_clock::now() + query.GetTimeout().value_or(std::chrono::milliseconds(0));
+
     SendQuery(query);
 
+    if (query.GetTimeout()) {
+        ReceiveUntil(deadline, query.GetCancelPolicy());
+        return;
+    }
+
     while (ReceivePacket()) {
         ;
     }
 }
 
+void Client::Impl::SelectRaw(Query query, SelectRawCallback cb) {
+    if (compression_ != CompressionState::Enable) {
+        throw ValidationError("raw data is available only when compression is enabled");
+    }
+
+    raw_data_cb_ = std::move(cb);
+    try {
+        ExecuteQuery(std::move(query));
+    } catch (...) {
+        raw_data_cb_ = nullptr;
+        throw;
+    }
+    raw_data_cb_ = nullptr;
+}
+
+void Client::Impl::ReceiveUntil(std::chrono::steady_clock::time_point deadline, QueryCancelPolicy policy) {
+    while (WaitForPacket(deadline)) {
+        if (!ReceivePacket()) {
+            return;
+        }
+    }
+
+    SendCancel();
+    // Whatever is received after the deadline is not delivered to the caller.
+    events_ = nullptr;
+    raw_data_cb_ = nullptr;
+
+    if (policy == QueryCancelPolicy::FastAbort) {
+        AbortQuery();
+    } else {
+        try {
+            while (ReceivePacket()) {
+                ;
+            }
+        } catch (const ServerError&) {
+            // Server may acknowledge cancellation with an exception.
+        }
+    }
+
+    throw TimeoutError("query has not been completed in time and was canceled");
+}
+
+void Client::Impl::AbortQuery() {
+    const auto deadline = std::chrono::steady_clock::now() + options_.query_cancel_timeout;
+
+    try {
+        while (WaitForPacket(deadline)) {
+            uint64_t packet_type = 0;
+
+            if (!WireFormat::ReadVarint64(*input_, &packet_type)) {
+                break;
+            }
+            // Server keeps sending data, there is no point in reading it.
+            if (packet_type == ServerCodes::Data || packet_type == ServerCodes::Totals || packet_type == ServerCodes::Extremes) {
+                break;
+            }
+            if (!ProcessPacket(packet_type)) {
+                return;
+            }
+        }
+    } catch (const ServerError&) {
+        return;
+    } catch (const std::system_error&) {
+        // Connection is going to be reset anyway.
+    }
+
+    ResetConnection();
+}
+
+bool Client::Impl::WaitForPacket(std::chrono::steady_clock::time_point deadline) const {
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now >= deadline) {
+        return false;
+    }
+    if (input_->HasBufferedData()) {
+        return true;
+    }
+
+    return socket_->waitForRead(std::chrono::ceil<std::chrono::milliseconds>(deadline - now));
+}
+
 std::string NameToQueryString(const std::string &input)
 {
     std::string output;
@@ -263,18 +452,111 @@ std::string NameToQueryString(const std::string &input)
 }
 
 void Client::Impl::Insert(const std::string& table_name, const std::string& query_id, const Block& block) {
+    Block structure;
+    EnsureNull en(options_.encode_low_cardinality_on_insert ? &structure : nullptr, &insert_structure_);
+
+    BeginInsert(table_name, query_id, block);
+
+    // Send data.
+    SendData(block);
+
+    EndInsert();
+}
+
+void Client::Impl::InsertNativeFile(const std::string& table_name, const std::string& query_id, const std::string& path) {
+    if (compression_ != CompressionState::Enable) {
+        throw ValidationError("native files hold compressed data, compression must be enabled");
+    }
+
+    const MappedFile file(path);
+
+    Block structure;
+    const auto blocks = ScanNativeFile(file, path, &structure);
+    if (blocks.empty()) {
+        return;
+    }
+
+    BeginInsert(table_name, query_id, structure);
+
+    // Older servers don't read the format of the file, blocks are converted for them.
+    const bool send_as_is = server_info_.revision >= NATIVE_FILE_REVISION;
+
+    for (const auto& [offset, size] : blocks) {
+        if (!send_as_is) {
+            ArrayInput input(file.Data() + offset, size);
+            CompressedInput compressed(&input);
+            Block block;
+            ReadNativeBlock(compressed, GetNativeFileFormatSettings(), &block);
+            SendData(block);
+            continue;
+        }
+
+        WireFormat::WriteUInt64(*output_, ClientCodes::Data);
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES) {
+            WireFormat::WriteString(*output_, std::string());
+        }
+        output_->Flush();
+
+        if (file.Descriptor() < 0 || !socket_->sendFile(file.Descriptor(), offset, size)) {
+            output_->Write(file.Data() + offset, size);
+            output_->Flush();
+        }
+    }
+
+    EndInsert();
+}
+
+std::vector<std::pair<size_t, size_t>> Client::Impl::ScanNativeFile(const MappedFile& file, const std::string& path, Block* structure) {
+    std::vector<std::pair<size_t, size_t>> blocks;
+    ArrayInput input(file.Data(), file.Size());
+
+    while (!input.Exhausted()) {
+        const size_t offset = file.Size() - input.Avail();
+        const auto error_prefix = "native file " + path + " has an invalid block at offset " + std::to_string(offset);
+
+        Block block;
+        try {
+            // Each block must end exactly at the end of a frame, so it can be sent in a packet of its own.
+            CompressedInput compressed(&input);
+            if (!ReadNativeBlock(compressed, GetNativeFileFormatSettings(), &block)) {
+                throw ValidationError(error_prefix + ": unexpected end of file");
+            }
+        } catch (const LZ4Error& e) {
+            throw ValidationError(error_prefix + ": " + e.what());
+        }
+
+        if (blocks.empty()) {
+            *structure = block;
+        } else {
+            bool same = block.GetColumnCount() == structure->GetColumnCount();
+            for (size_t i = 0; same && i < block.GetColumnCount(); ++i) {
+                same = block.GetColumnName(i) == structure->GetColumnName(i)
+                    && block[i]->Type()->IsEqual(structure->operator[](i)->Type());
+            }
+            if (!same) {
+                throw ValidationError(error_prefix + ": structure differs from the first block");
+            }
+        }
+
+        blocks.emplace_back(offset, file.Size() - input.Avail() - offset);
+    }
+
+    return blocks;
+}
+
+void Client::Impl::BeginInsert(const std::string& table_name, const std::string& query_id, const Block& structure) {
     if (options_.ping_before_query) {
         RetryGuard([this]() { Ping(); });
     }
 
     std::stringstream fields_section;
-        const auto num_columns = block.GetColumnCount();
+    const auto num_columns = structure.GetColumnCount();
 
     for (unsigned int i = 0; i < num_columns; ++i) {
         if (i == num_columns - 1) {
-            fields_section << NameToQueryString(block.GetColumnName(i));
+            fields_section << NameToQueryString(structure.GetColumnName(i));
         } else {
-            fields_section << NameToQueryString(block.GetColumnName(i)) << ",";
+            fields_section << NameToQueryString(structure.GetColumnName(i)) << ",";
         }
     }
 
@@ -296,9 +578,9 @@ void Client::Impl::Insert(const std::string& table_name, const std::string& quer
             continue;
         }
     }
+}
 
-    // Send data.
-    SendData(block);
+void Client::Impl::EndInsert() {
     // Send empty block as marker of
     // end of data.
     SendData(Block());
@@ -347,6 +629,9 @@ bool Client::Impl::Handshake() {
     if (!ReceiveHello()) {
         return false;
     }
+    if (server_info_.revision >= DBMS_MIN_REVISION_WITH_ADDENDUM) {
+        SendAddendum();
+    }
     return true;
 }
 
@@ -360,6 +645,10 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
         *server_packet = packet_type;
     }
 
+    return ProcessPacket(packet_type);
+}
+
+bool Client::Impl::ProcessPacket(uint64_t packet_type) {
     switch (packet_type) {
     case ServerCodes::Data: {
         if (!ReceiveData()) {
@@ -416,6 +705,11 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
                 return false;
             }
         }
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_TOTAL_BYTES_IN_PROGRESS) {
+            if (!WireFormat::ReadUInt64(*input_, &info.total_bytes)) {
+                return false;
+            }
+        }
         if (REVISION >= DBMS_MIN_REVISION_WITH_CLIENT_WRITE_INFO)
         {
             if (!WireFormat::ReadUInt64(*input_, &info.written_rows)) {
@@ -425,6 +719,11 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
                 return false;
             }
         }
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_SERVER_QUERY_TIME_IN_PROGRESS) {
+            if (!WireFormat::ReadUInt64(*input_, &info.elapsed_ns)) {
+                return false;
+            }
+        }
 
         if (events_) {
             events_->OnProgress(info);
@@ -495,6 +794,14 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
         return true;
     }
 
+    case ServerCodes::TimezoneUpdate: {
+        // Session timezone has been changed by a query, values are already sent in it.
+        if (!WireFormat::SkipString(*input_)) {
+            return false;
+        }
+        return true;
+    }
+
     default:
         throw UnimplementedError("unimplemented " + std::to_string((int)packet_type));
         break;
@@ -503,67 +810,27 @@ bool Client::Impl::ReceivePacket(uint64_t* server_packet) {
     return false;
 }
 
-bool Client::Impl::ReadBlock(InputStream& input, Block* block) {
-    // Additional information about block.
-    if (REVISION >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
-        uint64_t num;
-        BlockInfo info;
-
-        // BlockInfo
-        if (!WireFormat::ReadUInt64(input, &num)) {
-            return false;
-        }
-        if (!WireFormat::ReadFixed(input, &info.is_overflows)) {
-            return false;
-        }
-        if (!WireFormat::ReadUInt64(input, &num)) {
-            return false;
-        }
-        if (!WireFormat::ReadFixed(input, &info.bucket_num)) {
-            return false;
-        }
-        if (!WireFormat::ReadUInt64(input, &num)) {
-            return false;
-        }
-
-        block->SetInfo(std::move(info));
+NativeFormatSettings Client::Impl::GetNativeFormatSettings() const {
+    NativeFormatSettings settings;
+    settings.revision = server_info_.revision;
+    settings.create_column.low_cardinality_as_wrapped_column = options_.backward_compatibility_lowcardinality_as_wrapped_column;
+    settings.keep_sparse_columns = options_.keep_sparse_columns;
+    if (insert_structure_) {
+        // LowCardinality columns of the structure must keep their type.
+        settings.create_column.low_cardinality_as_wrapped_column = false;
+        settings.low_cardinality_structure = insert_structure_;
     }
+    return settings;
+}
 
-    uint64_t num_columns = 0;
-    uint64_t num_rows = 0;
-
-    if (!WireFormat::ReadUInt64(input, &num_columns)) {
-        return false;
-    }
-    if (!WireFormat::ReadUInt64(input, &num_rows)) {
-        return false;
-    }
-
-    CreateColumnByTypeSettings create_column_settings;
-    create_column_settings.low_cardinality_as_wrapped_column = options_.backward_compatibility_lowcardinality_as_wrapped_column;
-
-    std::string name;
-    std::string type;
-    for (size_t i = 0; i < num_columns; ++i) {
-        if (!WireFormat::ReadString(input, &name)) {
-            return false;
-        }
-        if (!WireFormat::ReadString(input, &type)) {
-            return false;
-        }
-
-        if (ColumnRef col = CreateColumnByType(type, create_column_settings)) {
-            if (num_rows && !col->Load(&input, num_rows)) {
-                throw ProtocolError("can't load column '" + name + "' of type " + type);
-            }
-
-            block->AppendColumn(name, col);
-        } else {
-            throw UnimplementedError(std::string("unsupported column type: ") + type);
-        }
-    }
+NativeFormatSettings Client::Impl::GetNativeFileFormatSettings() const {
+    NativeFormatSettings settings = GetNativeFormatSettings();
+    settings.revision = NATIVE_FILE_REVISION;
+    return settings;
+}
 
-    return true;
+bool Client::Impl::ReadBlock(InputStream& input, Block* block) {
+    return ReadNativeBlock(input, GetNativeFormatSettings(), block);
 }
 
 bool Client::Impl::ReceiveData() {
@@ -575,7 +842,20 @@ bool Client::Impl::ReceiveData() {
         }
     }
 
-    if (compression_ == CompressionState::Enable) {
+    if (compression_ == CompressionState::Enable && raw_data_cb_) {
+        RawBlock raw;
+        {
+            CompressedInput compressed(input_.get(), &raw.frames);
+            if (!ReadBlock(compressed, &block)) {
+                return false;
+            }
+        }
+        raw.columns = block.GetColumnCount();
+        raw.rows = block.GetRowCount();
+
+        raw_data_cb_(raw);
+        return true;
+    } else if (compression_ == CompressionState::Enable) {
         CompressedInput compressed(input_.get());
         if (!ReadBlock(compressed, &block)) {
             return false;
@@ -586,6 +866,10 @@ bool Client::Impl::ReceiveData() {
         }
     }
 
+    if (insert_structure_ && insert_structure_->GetColumnCount() == 0) {
+        *insert_structure_ = block;
+    }
+
     if (events_) {
         events_->OnData(block);
         if (!events_->OnDataCancelable(block)) {
@@ -650,6 +934,16 @@ void Client::Impl::SendCancel() {
 }
 
 void Client::Impl::SendQuery(const Query& query) {
+    // Validate external tables before anything is written to the connection.
+    if (!query.GetExternalTables().empty() && server_info_.revision < DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES) {
+        throw UnimplementedError(std::string("Can't send external tables to a server, server version is too old"));
+    }
+    for (const auto& table : query.GetExternalTables()) {
+        if (table.name.empty()) {
+            throw ValidationError("external table must have a name");
+        }
+    }
+
     WireFormat::WriteUInt64(*output_, ClientCodes::Query);
     WireFormat::WriteString(*output_, query.GetQueryID());
 
@@ -708,6 +1002,13 @@ void Client::Impl::SendQuery(const Query& query) {
                 throw UnimplementedError(std::string("Can't send open telemetry tracing context to a server, server version is too old"));
             }
         }
+
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_PARALLEL_REPLICAS) {
+            // collaborate_with_initiator, count_participating_replicas, number_of_current_replica
+            WireFormat::WriteUInt64(*output_, 0u);
+            WireFormat::WriteUInt64(*output_, 0u);
+            WireFormat::WriteUInt64(*output_, 0u);
+        }
     }
 
     /// Per query settings
@@ -732,6 +1033,15 @@ void Client::Impl::SendQuery(const Query& query) {
     WireFormat::WriteUInt64(*output_, Stages::Complete);
     WireFormat::WriteUInt64(*output_, compression_);
     WireFormat::WriteString(*output_, query.GetText());
+
+    if (server_info_.revision >= DBMS_MIN_REVISION_WITH_PARAMETERS) {
+        // Empty string signals end of serialized query parameters
+        WireFormat::WriteString(*output_, std::string());
+    }
+
+    for (const auto& table : query.GetExternalTables()) {
+        SendData(table.data, table.name);
+    }
     // Send empty block as marker of
     // end of data
     SendData(Block());
@@ -741,37 +1051,14 @@ void Client::Impl::SendQuery(const Query& query) {
 
 
 void Client::Impl::WriteBlock(const Block& block, OutputStream& output) {
-    // Additional information about block.
-    if (server_info_.revision >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
-        WireFormat::WriteUInt64(output, 1);
-        WireFormat::WriteFixed<uint8_t>(output, block.Info().is_overflows);
-        WireFormat::WriteUInt64(output, 2);
-        WireFormat::WriteFixed<int32_t>(output, block.Info().bucket_num);
-        WireFormat::WriteUInt64(output, 0);
-    }
-
-    WireFormat::WriteUInt64(output, block.GetColumnCount());
-    WireFormat::WriteUInt64(output, block.GetRowCount());
-
-    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
-        WireFormat::WriteString(output, bi.Name());
-        WireFormat::WriteString(output, bi.Type()->GetName());
-
-        // Empty columns are not serialized and occupy exactly 0 bytes.
-        // ref https://github.com/ClickHouse/ClickHouse/blob/39b37a3240f74f4871c8c1679910e065af6bea19/src/Formats/NativeWriter.cpp#L163
-        const bool containsData = block.GetRowCount() > 0;
-        if (containsData) {
-            bi.Column()->Save(&output);
-        }
-    }
-    output.Flush();
+    WriteNativeBlock(output, GetNativeFormatSettings(), block);
 }
 
-void Client::Impl::SendData(const Block& block) {
+void Client::Impl::SendData(const Block& block, const std::string& table_name) {
     WireFormat::WriteUInt64(*output_, ClientCodes::Data);
 
     if (server_info_.revision >= DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES) {
-        WireFormat::WriteString(*output_, std::string());
+        WireFormat::WriteString(*output_, table_name);
     }
 
     if (compression_ == CompressionState::Enable) {
@@ -790,7 +1077,7 @@ void Client::Impl::SendData(const Block& block) {
 
 void Client::Impl::InitializeStreams(std::unique_ptr<SocketBase>&& socket) {
     std::unique_ptr<OutputStream> output = std::make_unique<BufferedOutput>(socket->makeOutputStream());
-    std::unique_ptr<InputStream> input = std::make_unique<BufferedInput>(socket->makeInputStream());
+    std::unique_ptr<BufferedInput> input = std::make_unique<BufferedInput>(socket->makeInputStream());
 
     std::swap(input, input_);
     std::swap(output, output_);
@@ -812,6 +1099,14 @@ bool Client::Impl::SendHello() {
     return true;
 }
 
+void Client::Impl::SendAddendum() {
+    if (server_info_.revision >= DBMS_MIN_REVISION_WITH_QUOTA_KEY) {
+        WireFormat::WriteString(*output_, std::string());
+    }
+
+    output_->Flush();
+}
+
 bool Client::Impl::ReceiveHello() {
     uint64_t packet_type = 0;
 
@@ -851,6 +1146,26 @@ bool Client::Impl::ReceiveHello() {
             }
         }
 
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_PASSWORD_COMPLEXITY_RULES) {
+            uint64_t rules_size;
+            if (!WireFormat::ReadUInt64(*input_, &rules_size)) {
+                return false;
+            }
+            // Pairs of pattern and message, they are of use for clients that create users only.
+            for (uint64_t i = 0; i < rules_size * 2; ++i) {
+                if (!WireFormat::SkipString(*input_)) {
+                    return false;
+                }
+            }
+        }
+
+        if (server_info_.revision >= DBMS_MIN_REVISION_WITH_INTERSERVER_SECRET_V2) {
+            uint64_t nonce;
+            if (!WireFormat::ReadFixed(*input_, &nonce)) {
+                return false;
+            }
+        }
+
         return true;
     } else if (packet_type == ServerCodes::Exception) {
         ReceiveException(true);
@@ -922,6 +1237,32 @@ void Client::Select(const Query& query) {
     Execute(query);
 }
 
+void Client::SelectRaw(const std::string& query, SelectRawCallback cb) {
+    impl_->SelectRaw(Query(query), std::move(cb));
+}
+
+void Client::SelectRaw(const std::string& query, const std::string& query_id, SelectRawCallback cb) {
+    impl_->SelectRaw(Query(query, query_id), std::move(cb));
+}
+
+void Client::SelectRaw(const Query& query, SelectRawCallback cb) {
+    impl_->SelectRaw(query, std::move(cb));
+}
+
+Block Client::SelectAll(const std::string& query) {
+    return SelectAll(query, Query::default_query_id);
+}
+
+Block Client::SelectAll(const std::string& query, const std::string& query_id) {
+    BlockAccumulator accumulator;
+
+    Execute(Query(query, query_id).OnData([&accumulator](const Block& block) {
+        accumulator.Add(block);
+    }));
+
+    return accumulator.Release();
+}
+
 void Client::Insert(const std::string& table_name, const Block& block) {
     impl_->Insert(table_name, Query::default_query_id, block);
 }
@@ -930,6 +1271,14 @@ void Client::Insert(const std::string& table_name, const std::string& query_id,
     impl_->Insert(table_name, query_id, block);
 }
 
+void Client::InsertNativeFile(const std::string& table_name, const std::string& path) {
+    impl_->InsertNativeFile(table_name, Query::default_query_id, path);
+}
+
+void Client::InsertNativeFile(const std::string& table_name, const std::string& query_id, const std::string& path) {
+    impl_->InsertNativeFile(table_name, query_id, path);
+}
+
 void Client::Ping() {
     impl_->Ping();
 }
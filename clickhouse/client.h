@@ -14,6 +14,7 @@
 #include "columns/nullable.h"
 #include "columns/numeric.h"
 #include "columns/map.h"
+#include "columns/sparse.h"
 #include "columns/string.h"
 #include "columns/tuple.h"
 #include "columns/uuid.h"
@@ -92,6 +93,10 @@ struct ClientOptions {
     DECLARE_FIELD(connection_recv_timeout, std::chrono::milliseconds, SetConnectionRecvTimeout, std::chrono::milliseconds(0));
     DECLARE_FIELD(connection_send_timeout, std::chrono::milliseconds, SetConnectionSendTimeout, std::chrono::milliseconds(0));
 
+    /// How long to wait for the server to acknowledge cancellation of a query that has exceeded its timeout,
+    /// when QueryCancelPolicy::FastAbort is used. The connection is reset when the time is out.
+    DECLARE_FIELD(query_cancel_timeout, std::chrono::milliseconds, SetQueryCancelTimeout, std::chrono::milliseconds(1000));
+
     /** It helps to ease migration of the old codebases, which can't afford to switch
     * to using ColumnLowCardinalityT or ColumnLowCardinality directly,
     * but still want to benefit from smaller on-wire LowCardinality bandwidth footprint.
@@ -109,6 +114,18 @@ struct ClientOptions {
      */
     DECLARE_FIELD(max_compression_chunk_size, unsigned int, SetMaxCompressionChunkSize, 65535);
 
+    /** Server sends columns, that consist mostly of default values, in sparse serialization.
+     *  By default they are converted to ordinary columns when received,
+     *  if set, they are returned as ColumnSparse, which can be converted with ColumnSparse::Dense() later.
+     */
+    DECLARE_FIELD(keep_sparse_columns, bool, SetKeepSparseColumns, false);
+
+    /** String and FixedString columns (and Nullable of them), which are inserted into LowCardinality columns,
+     *  are dictionary-encoded by the client, so each distinct value is sent only once per block.
+     *  Types of columns of the table are taken from the structure, which the server sends in reply to INSERT query.
+     */
+    DECLARE_FIELD(encode_low_cardinality_on_insert, bool, SetEncodeLowCardinalityOnInsert, false);
+
     struct SSLOptions {
         /** There are two ways to configure an SSL connection:
          *  - provide a pre-configured SSL_CTX, which is not modified and not owned by the Client.
@@ -224,10 +241,34 @@ public:
     /// Alias for Execute.
     void Select(const Query& query);
 
+    /// Executes a select query and passes the data to \p cb in the form it has been received,
+    /// i.e. as compressed frames, which may be stored or sent further without re-encoding.
+    /// Frames are still checked and decompressed to find the end of each block.
+    /// Requires compression to be enabled.
+    void SelectRaw(const std::string& query, SelectRawCallback cb);
+    void SelectRaw(const std::string& query, const std::string& query_id, SelectRawCallback cb);
+    /// Blocks are passed to \p cb instead of data callbacks of the query, its timeout applies too.
+    void SelectRaw(const Query& query, SelectRawCallback cb);
+
+    /// Executes a select query and returns all received data as a single block.
+    /// Each column of the result is concatenated only once, with capacity
+    /// reserved up-front for the exact number of received rows.
+    Block SelectAll(const std::string& query);
+    Block SelectAll(const std::string& query, const std::string& query_id);
+
     /// Intends for insert block of data into a table \p table_name.
     void Insert(const std::string& table_name, const Block& block);
     void Insert(const std::string& table_name, const std::string& query_id, const Block& block);
 
+    /// Inserts data from the file \p path into a table \p table_name. The file must contain
+    /// compressed blocks in the form they are sent over the wire at NATIVE_FILE_REVISION, e.g. written
+    /// with NativeFileWriter or saved from SelectRaw() of a server of that revision or newer.
+    /// Blocks are checked once and then sent straight from the file, with sendfile() where supported.
+    /// Servers of older revisions get blocks converted to their format.
+    /// Requires compression to be enabled.
+    void InsertNativeFile(const std::string& table_name, const std::string& path);
+    void InsertNativeFile(const std::string& table_name, const std::string& query_id, const std::string& path);
+
     /// Ping server for aliveness.
     void Ping();
 
@@ -17,6 +17,37 @@ ColumnArray::ColumnArray(ColumnRef data, std::shared_ptr<ColumnUInt64> offsets)
 {
 }
 
+ColumnArray::ColumnArray(ColumnRef data, std::vector<uint64_t>&& offsets)
+    : ColumnArray(data)
+{
+    if (offsets.empty() || offsets.front() != 0) {
+        throw ValidationError("offsets of ColumnArray must start with zero");
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+        if (offsets[i] < offsets[i - 1]) {
+            throw ValidationError("offsets of ColumnArray must not decrease");
+        }
+    }
+    if (offsets.back() != data_->Size()) {
+        throw ValidationError("last offset of ColumnArray " + std::to_string(offsets.back())
+                + " does not match size of nested column " + std::to_string(data_->Size()));
+    }
+
+    // Ends of arrays are stored, without the leading zero.
+    offsets.erase(offsets.begin());
+    offsets_ = std::make_shared<ColumnUInt64>(std::move(offsets));
+}
+
+std::shared_ptr<ColumnArray> ColumnArray::FromLengths(ColumnRef data, const std::vector<uint64_t>& lengths) {
+    std::vector<uint64_t> offsets;
+    offsets.reserve(lengths.size() + 1);
+    offsets.push_back(0);
+    for (auto length : lengths) {
+        offsets.push_back(offsets.back() + length);
+    }
+    return std::make_shared<ColumnArray>(data, std::move(offsets));
+}
+
 ColumnArray::ColumnArray(ColumnArray&& other)
     : Column(other.Type())
     , data_(std::move(other.data_))
@@ -53,6 +84,32 @@ ColumnRef ColumnArray::Slice(size_t begin, size_t size) const {
     return result;
 }
 
+ColumnRef ColumnArray::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    size_t total_size = 0;
+    for (auto index : indices) {
+        total_size += GetSize(index);
+    }
+
+    // Elements of the selected arrays, one after another.
+    std::vector<size_t> elements;
+    elements.reserve(total_size);
+    std::vector<uint64_t> offsets;
+    offsets.reserve(indices.size());
+
+    for (auto index : indices) {
+        const size_t offset = GetOffset(index);
+        const size_t size = GetSize(index);
+        for (size_t i = 0; i < size; ++i) {
+            elements.push_back(offset + i);
+        }
+        offsets.push_back(elements.size());
+    }
+
+    return std::make_shared<ColumnArray>(data_->Permute(elements), std::make_shared<ColumnUInt64>(std::move(offsets)));
+}
+
 ColumnRef ColumnArray::CloneEmpty() const {
     return std::make_shared<ColumnArray>(data_->CloneEmpty());
 }
@@ -63,9 +120,27 @@ void ColumnArray::Append(ColumnRef column) {
             return;
         }
 
-        for (size_t i = 0; i < col->Size(); ++i) {
-            AppendAsColumn(col->GetAsColumn(i));
+        const auto& offsets = col->Offsets();
+        if (offsets.empty()) {
+            return;
         }
+
+        // Nested column may be the same as the current one (or hold more values than arrays refer to),
+        // so only values of arrays are copied.
+        const size_t count = offsets.back();
+        ColumnRef nested = col->data_;
+        if (nested == data_ || nested->Size() != count) {
+            nested = nested->Slice(0, count);
+        }
+
+        const uint64_t base = GetOffset(Size());
+        std::vector<uint64_t> rebased(offsets.size());
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            rebased[i] = base + offsets[i];
+        }
+
+        data_->Append(nested);
+        offsets_->Append(std::make_shared<ColumnUInt64>(std::move(rebased)));
     }
 }
 
@@ -104,6 +179,10 @@ void ColumnArray::Clear() {
     data_->Clear();
 }
 
+void ColumnArray::Reserve(size_t new_cap) {
+    offsets_->Reserve(new_cap);
+}
+
 size_t ColumnArray::Size() const {
     return offsets_->Size();
 }
@@ -33,6 +33,17 @@ public:
      */
     ColumnArray(ColumnRef data, std::shared_ptr<ColumnUInt64> offsets);
 
+    /** Create an array from values of all arrays, one after another, and offsets of arrays in `data`
+     *  (CSR layout): offsets start with zero and end with the size of `data`, so there is
+     *  one more offset than rows, the i-th array is [offsets[i], offsets[i + 1]).
+     *
+     *  `data` is used internally (and modified) by ColumnArray.
+     */
+    ColumnArray(ColumnRef data, std::vector<uint64_t>&& offsets);
+
+    /// Create an array from values of all arrays, one after another, and sizes of arrays.
+    static std::shared_ptr<ColumnArray> FromLengths(ColumnRef data, const std::vector<uint64_t>& lengths);
+
     /// Converts input column to array and appends as one row to the current column.
     void AppendAsColumn(ColumnRef array);
 
@@ -46,8 +57,15 @@ public:
         return GetAsColumn(n)->AsStrict<T>();
     }
 
+    /// Returns column of elements of all arrays.
+    inline ColumnRef Nested() const { return data_; }
+
+    /// Returns offsets of the ends of arrays in the nested column.
+    inline const std::vector<uint64_t>& Offsets() const { return offsets_->GetData(); }
+
 public:
     /// Appends content of given column to the end of current one.
+    /// Nested column is appended at once, offsets are shifted by the current size of it.
     void Append(ColumnRef column) override;
 
     /// Loads column prefix from input stream.
@@ -65,11 +83,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t, size_t) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column&) override;
 
@@ -108,6 +130,12 @@ public:
         , typed_nested_data_(data)
     {}
 
+    /// Create an array from values of all arrays and offsets of arrays in CSR layout, see ColumnArray.
+    ColumnArrayT(std::shared_ptr<NestedColumnType> data, std::vector<uint64_t>&& offsets)
+        : ColumnArray(data, std::move(offsets))
+        , typed_nested_data_(data)
+    {}
+
     template <typename ...Args>
     explicit ColumnArrayT(Args &&... args)
         : ColumnArrayT(std::make_shared<NestedColumnType>(std::forward<Args>(args)...))
@@ -285,6 +313,10 @@ public:
         return Wrap(ColumnArray::Slice(begin, size));
     }
 
+    ColumnRef Permute(const std::vector<size_t>& indices) const override {
+        return Wrap(ColumnArray::Permute(indices));
+    }
+
     ColumnRef CloneEmpty() const override {
         return Wrap(ColumnArray::CloneEmpty());
     }
@@ -1,5 +1,7 @@
 #include "column.h"
 
+#include <string>
+
 namespace clickhouse {
 
 bool Column::LoadPrefix(InputStream*, size_t) {
@@ -15,10 +17,101 @@ void Column::SavePrefix(OutputStream*) {
     /// does nothing by default
 }
 
+void Column::Reserve(size_t) {
+    /// does nothing by default
+}
+
 /// Saves column data to output stream.
 void Column::Save(OutputStream* output) {
     SavePrefix(output);
     SaveBody(output);
 }
 
+ColumnRef Column::Filter(const std::vector<uint8_t>& mask) const {
+    CheckFilterMask(mask);
+
+    std::vector<size_t> indices;
+    indices.reserve(mask.size());
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i]) {
+            indices.push_back(i);
+        }
+    }
+
+    return Permute(indices);
+}
+
+ColumnRef Column::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    auto result = CloneEmpty();
+    result->Reserve(indices.size());
+
+    // Runs of consecutive rows are appended at once.
+    for (size_t i = 0; i < indices.size(); ) {
+        size_t j = i + 1;
+        while (j < indices.size() && indices[j] == indices[j - 1] + 1) {
+            ++j;
+        }
+        result->Append(Slice(indices[i], j - i));
+        i = j;
+    }
+
+    return result;
+}
+
+std::vector<ColumnRef> Column::Scatter(const std::vector<size_t>& selector, size_t num_columns) const {
+    CheckSelector(selector, num_columns);
+
+    std::vector<size_t> sizes(num_columns);
+    for (auto column : selector) {
+        ++sizes[column];
+    }
+
+    std::vector<std::vector<size_t>> indices(num_columns);
+    for (size_t i = 0; i < num_columns; ++i) {
+        indices[i].reserve(sizes[i]);
+    }
+    for (size_t row = 0; row < selector.size(); ++row) {
+        indices[selector[row]].push_back(row);
+    }
+
+    std::vector<ColumnRef> result;
+    result.reserve(num_columns);
+    for (const auto& rows : indices) {
+        result.push_back(Permute(rows));
+    }
+
+    return result;
+}
+
+void Column::CheckFilterMask(const std::vector<uint8_t>& mask) const {
+    if (mask.size() != Size()) {
+        throw ValidationError("Size of filter mask " + std::to_string(mask.size())
+                + " doesn't match size of column " + std::to_string(Size()));
+    }
+}
+
+void Column::CheckPermutation(const std::vector<size_t>& indices) const {
+    const size_t size = Size();
+    for (auto index : indices) {
+        if (index >= size) {
+            throw ValidationError("Index is out ouf bounds: " + std::to_string(index));
+        }
+    }
+}
+
+void Column::CheckSelector(const std::vector<size_t>& selector, size_t num_columns) const {
+    if (selector.size() != Size()) {
+        throw ValidationError("Size of selector " + std::to_string(selector.size())
+                + " doesn't match size of column " + std::to_string(Size()));
+    }
+    for (auto column : selector) {
+        if (column >= num_columns) {
+            throw ValidationError("Selector refers to column " + std::to_string(column)
+                    + " of " + std::to_string(num_columns));
+        }
+    }
+}
+
 }
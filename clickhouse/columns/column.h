@@ -4,8 +4,10 @@
 #include "../columns/itemview.h"
 #include "../exceptions.h"
 
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <vector>
 
 namespace clickhouse {
 
@@ -77,12 +79,28 @@ public:
     /// Clear column data .
     virtual void Clear() = 0;
 
+    /// Increase the capacity of the column for large block insertion.
+    /// Does nothing by default, may be overridden by columns that can preallocate storage.
+    virtual void Reserve(size_t new_cap);
+
     /// Returns count of rows in the column.
     virtual size_t Size() const = 0;
 
     /// Makes slice of the current column.
     virtual ColumnRef Slice(size_t begin, size_t len) const = 0;
 
+    /// Returns column with the rows, for which `mask` is non-zero, in the same order.
+    /// Size of `mask` must be equal to count of rows in the column.
+    virtual ColumnRef Filter(const std::vector<uint8_t>& mask) const;
+
+    /// Returns column, which i-th row is a copy of the `indices[i]`-th row of the current one.
+    /// Rows may be reordered, repeated or omitted.
+    virtual ColumnRef Permute(const std::vector<size_t>& indices) const;
+
+    /// Splits rows between `num_columns` columns: each row goes to the column with index `selector[row]`,
+    /// preserving the order of rows. Size of `selector` must be equal to count of rows in the column.
+    virtual std::vector<ColumnRef> Scatter(const std::vector<size_t>& selector, size_t num_columns) const;
+
     virtual ColumnRef CloneEmpty() const = 0;
 
     virtual void Swap(Column&) = 0;
@@ -97,6 +115,12 @@ public:
         left.Swap(right);
     }
 
+protected:
+    /// Throw ValidationError if arguments of Filter(), Permute() or Scatter() don't match the column.
+    void CheckFilterMask(const std::vector<uint8_t>& mask) const;
+    void CheckPermutation(const std::vector<size_t>& indices) const;
+    void CheckSelector(const std::vector<size_t>& selector, size_t num_columns) const;
+
 protected:
     TypeRef type_;
 };
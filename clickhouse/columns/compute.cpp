@@ -0,0 +1,304 @@
+#include "compute.h"
+
+#include "../exceptions.h"
+
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__amd64__)) && (defined(__GNUC__) || defined(__clang__))
+#   define WITH_AVX2_DISPATCH
+#   define TARGET_AVX2 __attribute__((target("avx2")))
+#   define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#   define ALWAYS_INLINE inline
+#endif
+
+namespace clickhouse {
+
+namespace {
+
+/// Loops are unrolled by independent accumulators, so they are vectorized
+/// without reassociation of floating-point operations.
+constexpr size_t LANES = 8;
+
+/// Kernels are structs with a static Run(), which is inlined into the dispatched
+/// function and compiled for its target.
+template <typename Kernel, typename... Args>
+ALWAYS_INLINE auto RunDefault(Args... args) {
+    return Kernel::Run(args...);
+}
+
+#if defined(WITH_AVX2_DISPATCH)
+
+template <typename Kernel, typename... Args>
+TARGET_AVX2 auto RunAvx2(Args... args) {
+    return Kernel::Run(args...);
+}
+
+bool HasAvx2() {
+    static const bool has_avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has_avx2;
+}
+
+#endif
+
+template <typename Kernel, typename... Args>
+auto Dispatch(Args... args) {
+#if defined(WITH_AVX2_DISPATCH)
+    if (HasAvx2()) {
+        return RunAvx2<Kernel>(args...);
+    }
+#endif
+    return RunDefault<Kernel>(args...);
+}
+
+/// Null map is nullptr for columns, which are not Nullable.
+template <typename T, bool HasNulls>
+struct SumKernel {
+    /// Integers are summed as unsigned to wrap around without undefined behavior.
+    using Accumulator = std::conditional_t<std::is_floating_point_v<T>, double, uint64_t>;
+
+    static ALWAYS_INLINE Accumulator Value(const T* data, const uint8_t* nulls, size_t i) {
+        if constexpr (HasNulls) {
+            return nulls[i] ? Accumulator(0) : static_cast<Accumulator>(data[i]);
+        } else {
+            return static_cast<Accumulator>(data[i]);
+        }
+    }
+
+    static ALWAYS_INLINE SumType<T> Run(const T* data, const uint8_t* nulls, size_t size) {
+        Accumulator lanes[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES) {
+            for (size_t j = 0; j < LANES; ++j) {
+                lanes[j] += Value(data, nulls, i + j);
+            }
+        }
+
+        Accumulator result = 0;
+        for (size_t j = 0; j < LANES; ++j) {
+            result += lanes[j];
+        }
+        for (; i < size; ++i) {
+            result += Value(data, nulls, i);
+        }
+        return static_cast<SumType<T>>(result);
+    }
+};
+
+template <typename T, bool IsMax, bool HasNulls>
+struct ExtremeKernel {
+    /// Null rows are replaced with the value, which never wins.
+    static constexpr T Neutral() {
+        if constexpr (std::is_floating_point_v<T>) {
+            return IsMax ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+        } else {
+            return IsMax ? std::numeric_limits<T>::lowest() : std::numeric_limits<T>::max();
+        }
+    }
+
+    static ALWAYS_INLINE T Select(T a, T b) {
+        if constexpr (IsMax) {
+            return b > a ? b : a;
+        } else {
+            return b < a ? b : a;
+        }
+    }
+
+    static ALWAYS_INLINE T Value(const T* data, const uint8_t* nulls, size_t i) {
+        if constexpr (HasNulls) {
+            return nulls[i] ? Neutral() : data[i];
+        } else {
+            return data[i];
+        }
+    }
+
+    static ALWAYS_INLINE T Run(const T* data, const uint8_t* nulls, size_t size) {
+        T lanes[LANES];
+        for (size_t j = 0; j < LANES; ++j) {
+            lanes[j] = Neutral();
+        }
+
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES) {
+            for (size_t j = 0; j < LANES; ++j) {
+                lanes[j] = Select(lanes[j], Value(data, nulls, i + j));
+            }
+        }
+
+        T result = Neutral();
+        for (size_t j = 0; j < LANES; ++j) {
+            result = Select(result, lanes[j]);
+        }
+        for (; i < size; ++i) {
+            result = Select(result, Value(data, nulls, i));
+        }
+        return result;
+    }
+};
+
+struct CountNullsKernel {
+    static ALWAYS_INLINE size_t Run(const uint8_t* nulls, size_t size) {
+        size_t count = 0;
+        for (size_t i = 0; i < size; ++i) {
+            count += nulls[i] != 0;
+        }
+        return count;
+    }
+};
+
+template <typename T, CompareOp Op, bool HasNulls>
+struct CompareKernel {
+    static ALWAYS_INLINE bool Apply(T a, T b) {
+        switch (Op) {
+            case CompareOp::Equals:          return a == b;
+            case CompareOp::NotEquals:       return a != b;
+            case CompareOp::Less:            return a < b;
+            case CompareOp::LessOrEquals:    return a <= b;
+            case CompareOp::Greater:         return a > b;
+            case CompareOp::GreaterOrEquals: return a >= b;
+        }
+        return false;
+    }
+
+    static ALWAYS_INLINE void Run(const T* data, const uint8_t* nulls, size_t size, T scalar, uint8_t* mask) {
+        for (size_t i = 0; i < size; ++i) {
+            if constexpr (HasNulls) {
+                mask[i] = static_cast<uint8_t>(Apply(data[i], scalar) & (nulls[i] == 0));
+            } else {
+                mask[i] = static_cast<uint8_t>(Apply(data[i], scalar));
+            }
+        }
+    }
+};
+
+template <typename T, bool HasNulls>
+void CompareImpl(const T* data, const uint8_t* nulls, size_t size, CompareOp op, T scalar, uint8_t* mask) {
+    switch (op) {
+        case CompareOp::Equals:
+            return Dispatch<CompareKernel<T, CompareOp::Equals, HasNulls>>(data, nulls, size, scalar, mask);
+        case CompareOp::NotEquals:
+            return Dispatch<CompareKernel<T, CompareOp::NotEquals, HasNulls>>(data, nulls, size, scalar, mask);
+        case CompareOp::Less:
+            return Dispatch<CompareKernel<T, CompareOp::Less, HasNulls>>(data, nulls, size, scalar, mask);
+        case CompareOp::LessOrEquals:
+            return Dispatch<CompareKernel<T, CompareOp::LessOrEquals, HasNulls>>(data, nulls, size, scalar, mask);
+        case CompareOp::Greater:
+            return Dispatch<CompareKernel<T, CompareOp::Greater, HasNulls>>(data, nulls, size, scalar, mask);
+        case CompareOp::GreaterOrEquals:
+            return Dispatch<CompareKernel<T, CompareOp::GreaterOrEquals, HasNulls>>(data, nulls, size, scalar, mask);
+    }
+}
+
+const uint8_t* GetNullMap(const ColumnNullable& column) {
+    return column.Nulls()->As<ColumnUInt8>()->GetData().data();
+}
+
+template <typename T>
+const ColumnVector<T>& GetNested(const ColumnNullable& column) {
+    const auto nested = column.Nested();
+    if (const auto col = dynamic_cast<const ColumnVector<T>*>(nested.get())) {
+        return *col;
+    }
+    throw ValidationError("unexpected nested column of " + column.Type()->GetName());
+}
+
+template <typename T, bool IsMax>
+std::optional<T> Extreme(const ColumnVector<T>& column) {
+    const auto& data = column.GetData();
+    if (data.empty()) {
+        return std::nullopt;
+    }
+    return Dispatch<ExtremeKernel<T, IsMax, false>>(data.data(), static_cast<const uint8_t*>(nullptr), data.size());
+}
+
+template <typename T, bool IsMax>
+std::optional<T> Extreme(const ColumnNullable& column) {
+    const auto& data = GetNested<T>(column).GetData();
+    if (CountNonNull(column) == 0) {
+        return std::nullopt;
+    }
+    return Dispatch<ExtremeKernel<T, IsMax, true>>(data.data(), GetNullMap(column), data.size());
+}
+
+}
+
+template <typename T>
+SumType<T> Sum(const ColumnVector<T>& column) {
+    const auto& data = column.GetData();
+    return Dispatch<SumKernel<T, false>>(data.data(), static_cast<const uint8_t*>(nullptr), data.size());
+}
+
+template <typename T>
+SumType<T> Sum(const ColumnNullable& column) {
+    const auto& data = GetNested<T>(column).GetData();
+    return Dispatch<SumKernel<T, true>>(data.data(), GetNullMap(column), data.size());
+}
+
+template <typename T>
+std::optional<T> Min(const ColumnVector<T>& column) {
+    return Extreme<T, false>(column);
+}
+
+template <typename T>
+std::optional<T> Min(const ColumnNullable& column) {
+    return Extreme<T, false>(column);
+}
+
+template <typename T>
+std::optional<T> Max(const ColumnVector<T>& column) {
+    return Extreme<T, true>(column);
+}
+
+template <typename T>
+std::optional<T> Max(const ColumnNullable& column) {
+    return Extreme<T, true>(column);
+}
+
+size_t CountNonNull(const ColumnNullable& column) {
+    const size_t size = column.Size();
+    return size - Dispatch<CountNullsKernel>(GetNullMap(column), size);
+}
+
+template <typename T>
+std::vector<uint8_t> Compare(const ColumnVector<T>& column, CompareOp op, const typename ColumnVector<T>::ValueType& scalar) {
+    const auto& data = column.GetData();
+    std::vector<uint8_t> mask(data.size());
+    CompareImpl<T, false>(data.data(), nullptr, data.size(), op, scalar, mask.data());
+    return mask;
+}
+
+template <typename T>
+std::vector<uint8_t> Compare(const ColumnNullable& column, CompareOp op, const typename ColumnVector<T>::ValueType& scalar) {
+    const auto& data = GetNested<T>(column).GetData();
+    std::vector<uint8_t> mask(data.size());
+    CompareImpl<T, true>(data.data(), GetNullMap(column), data.size(), op, scalar, mask.data());
+    return mask;
+}
+
+#define INSTANTIATE_KERNELS(T) \
+    template SumType<T> Sum<T>(const ColumnVector<T>&); \
+    template SumType<T> Sum<T>(const ColumnNullable&); \
+    template std::optional<T> Min<T>(const ColumnVector<T>&); \
+    template std::optional<T> Min<T>(const ColumnNullable&); \
+    template std::optional<T> Max<T>(const ColumnVector<T>&); \
+    template std::optional<T> Max<T>(const ColumnNullable&); \
+    template std::vector<uint8_t> Compare<T>(const ColumnVector<T>&, CompareOp, const T&); \
+    template std::vector<uint8_t> Compare<T>(const ColumnNullable&, CompareOp, const T&);
+
+INSTANTIATE_KERNELS(int8_t)
+INSTANTIATE_KERNELS(int16_t)
+INSTANTIATE_KERNELS(int32_t)
+INSTANTIATE_KERNELS(int64_t)
+INSTANTIATE_KERNELS(uint8_t)
+INSTANTIATE_KERNELS(uint16_t)
+INSTANTIATE_KERNELS(uint32_t)
+INSTANTIATE_KERNELS(uint64_t)
+INSTANTIATE_KERNELS(float)
+INSTANTIATE_KERNELS(double)
+
+#undef INSTANTIATE_KERNELS
+
+}
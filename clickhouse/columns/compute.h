@@ -0,0 +1,66 @@
+#pragma once
+
+#include "nullable.h"
+#include "numeric.h"
+
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace clickhouse {
+
+/**
+ * Kernels, which compute aggregates and filters over the storage of numeric columns
+ * without per-row virtual calls and bounds checks.
+ *
+ * Kernels are available for integer and floating-point columns: ColumnVector<T>
+ * and ColumnNullable with such nested column, null rows of which are skipped.
+ * On x86-64 the kernels are compiled for AVX2 too, the variant is selected
+ * by the CPU at runtime.
+ */
+
+/// Type of the sum of values, as of sum() of ClickHouse: Int64, UInt64 or Float64.
+template <typename T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, double,
+                std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+enum class CompareOp {
+    Equals,
+    NotEquals,
+    Less,
+    LessOrEquals,
+    Greater,
+    GreaterOrEquals,
+};
+
+/// Sum of values. Sum of integers wraps around on overflow,
+/// floating-point values are summed in an unspecified order.
+template <typename T>
+SumType<T> Sum(const ColumnVector<T>& column);
+template <typename T>
+SumType<T> Sum(const ColumnNullable& column);
+
+/// Minimum and maximum of values, nullopt if there are no non-null values.
+/// Result is unspecified if values contain NaN.
+template <typename T>
+std::optional<T> Min(const ColumnVector<T>& column);
+template <typename T>
+std::optional<T> Min(const ColumnNullable& column);
+
+template <typename T>
+std::optional<T> Max(const ColumnVector<T>& column);
+template <typename T>
+std::optional<T> Max(const ColumnNullable& column);
+
+/// Count of rows, which are not null.
+size_t CountNonNull(const ColumnNullable& column);
+
+/// Returns mask with 1 for rows, where `value op scalar` holds, and 0 for the others
+/// and for null rows. Mask may be passed to Column::Filter().
+template <typename T>
+std::vector<uint8_t> Compare(const ColumnVector<T>& column, CompareOp op, const typename ColumnVector<T>::ValueType& scalar);
+template <typename T>
+std::vector<uint8_t> Compare(const ColumnNullable& column, CompareOp op, const typename ColumnVector<T>::ValueType& scalar);
+
+}
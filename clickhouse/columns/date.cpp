@@ -17,6 +17,10 @@ void ColumnDate::Clear() {
     data_->Clear();
 }
 
+void ColumnDate::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 std::time_t ColumnDate::At(size_t n) const {
     return static_cast<std::time_t>(data_->At(n)) * 86400;
 }
@@ -48,6 +52,12 @@ ColumnRef ColumnDate::Slice(size_t begin, size_t len) const {
     return result;
 }
 
+ColumnRef ColumnDate::Permute(const std::vector<size_t>& indices) const {
+    auto result = std::make_shared<ColumnDate>();
+    result->data_ = data_->Permute(indices)->As<ColumnUInt16>();
+    return result;
+}
+
 ColumnRef ColumnDate::CloneEmpty() const {
     return std::make_shared<ColumnDate>();
 }
@@ -69,6 +79,12 @@ ColumnDate32::ColumnDate32()
 {
 }
 
+ColumnDate32::ColumnDate32(std::vector<int32_t>&& data)
+    : Column(Type::CreateDate32())
+    , data_(std::make_shared<ColumnInt32>(std::move(data)))
+{
+}
+
 void ColumnDate32::Append(const std::time_t& value) {
     /// TODO: This code is fundamentally wrong.
     data_->Append(static_cast<int32_t>(value / std::time_t(86400)));
@@ -78,6 +94,10 @@ void ColumnDate32::Clear() {
     data_->Clear();
 }
 
+void ColumnDate32::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 std::time_t ColumnDate32::At(size_t n) const {
     return static_cast<std::time_t>(data_->At(n)) * 86400;
 }
@@ -109,6 +129,12 @@ ColumnRef ColumnDate32::Slice(size_t begin, size_t len) const {
     return result;
 }
 
+ColumnRef ColumnDate32::Permute(const std::vector<size_t>& indices) const {
+    auto result = std::make_shared<ColumnDate32>();
+    result->data_ = data_->Permute(indices)->As<ColumnInt32>();
+    return result;
+}
+
 ColumnRef ColumnDate32::CloneEmpty() const {
     return std::make_shared<ColumnDate32>();
 }
@@ -135,6 +161,12 @@ ColumnDateTime::ColumnDateTime(std::string timezone)
 {
 }
 
+ColumnDateTime::ColumnDateTime(std::string timezone, std::vector<uint32_t>&& data)
+    : Column(Type::CreateDateTime(std::move(timezone)))
+    , data_(std::make_shared<ColumnUInt32>(std::move(data)))
+{
+}
+
 void ColumnDateTime::Append(const std::time_t& value) {
     data_->Append(static_cast<uint32_t>(value));
 }
@@ -169,6 +201,10 @@ void ColumnDateTime::Clear() {
     data_->Clear();
 }
 
+void ColumnDateTime::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 ColumnRef ColumnDateTime::Slice(size_t begin, size_t len) const {
     auto col = data_->Slice(begin, len)->As<ColumnUInt32>();
     auto result = std::make_shared<ColumnDateTime>();
@@ -178,6 +214,12 @@ ColumnRef ColumnDateTime::Slice(size_t begin, size_t len) const {
     return result;
 }
 
+ColumnRef ColumnDateTime::Permute(const std::vector<size_t>& indices) const {
+    auto result = std::make_shared<ColumnDateTime>(Timezone());
+    result->data_ = data_->Permute(indices)->As<ColumnUInt32>();
+    return result;
+}
+
 ColumnRef ColumnDateTime::CloneEmpty() const {
     return std::make_shared<ColumnDateTime>();
 }
@@ -241,6 +283,10 @@ void ColumnDateTime64::SaveBody(OutputStream* output) {
 void ColumnDateTime64::Clear() {
     data_->Clear();
 }
+
+void ColumnDateTime64::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
 size_t ColumnDateTime64::Size() const {
     return data_->Size();
 }
@@ -265,6 +311,10 @@ ColumnRef ColumnDateTime64::Slice(size_t begin, size_t len) const {
     return ColumnRef{new ColumnDateTime64(type_, sliced_data)};
 }
 
+ColumnRef ColumnDateTime64::Permute(const std::vector<size_t>& indices) const {
+    return ColumnRef{new ColumnDateTime64(type_, data_->Permute(indices)->As<ColumnDecimal>())};
+}
+
 ColumnRef ColumnDateTime64::CloneEmpty() const {
     return ColumnRef{new ColumnDateTime64(type_, data_->CloneEmpty()->As<ColumnDecimal>())};
 }
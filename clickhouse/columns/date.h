@@ -22,6 +22,9 @@ public:
     /// TODO: The implementation is fundamentally wrong.
     std::time_t At(size_t n) const;
 
+    /// Returns days since epoch of all elements, as they are stored in the column.
+    inline const std::vector<uint16_t>& GetRawData() const { return data_->GetData(); }
+
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
 
@@ -34,11 +37,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -54,6 +61,8 @@ public:
     using ValueType = std::time_t;
 
     ColumnDate32();
+    /// Creates column from days since epoch.
+    explicit ColumnDate32(std::vector<int32_t>&& data);
 
     /// Appends one element to the end of column.
     /// TODO: The implementation is fundamentally wrong.
@@ -63,6 +72,9 @@ public:
     /// TODO: The implementation is fundamentally wrong.
     std::time_t At(size_t n) const;
 
+    /// Returns days since epoch of all elements, as they are stored in the column.
+    inline const std::vector<int32_t>& GetRawData() const { return data_->GetData(); }
+
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
 
@@ -75,11 +87,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -97,6 +113,8 @@ public:
 
     ColumnDateTime();
     explicit ColumnDateTime(std::string timezone);
+    /// Creates column from seconds since epoch.
+    ColumnDateTime(std::string timezone, std::vector<uint32_t>&& data);
 
     /// Appends one element to the end of column.
     void Append(const std::time_t& value);
@@ -104,6 +122,9 @@ public:
     /// Returns element at given row number.
     std::time_t At(size_t n) const;
 
+    /// Returns seconds since epoch of all elements, as they are stored in the column.
+    inline const std::vector<uint32_t>& GetRawData() const { return data_->GetData(); }
+
     /// Timezone associated with a data column.
     std::string Timezone() const;
 
@@ -117,6 +138,9 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Saves column data to output stream.
     void SaveBody(OutputStream* output) override;
 
@@ -125,6 +149,7 @@ public:
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -165,6 +190,9 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Saves column data to output stream.
     void SaveBody(OutputStream* output) override;
 
@@ -173,6 +201,7 @@ public:
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
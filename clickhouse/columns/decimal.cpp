@@ -1,5 +1,7 @@
 #include "decimal.h"
 
+#include <cstring>
+
 namespace
 {
 using namespace clickhouse;
@@ -95,6 +97,146 @@ inline bool mulOverflow(const Int128 & l, const T & r, Int128 * result)
 }
 #endif
 
+constexpr uint64_t POWERS_OF_TEN[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+    1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+    1000000000000000000ull
+};
+
+/// Digits are collected in a 64-bit integer, which is merged into the 128-bit value,
+/// when it may overflow, so overflow of the value is checked once per 18 digits at most.
+class DecimalDigits {
+public:
+    inline void Add(uint64_t digit) {
+        if (count_ == 18) {
+            Merge();
+        }
+        part_ = part_ * 10 + digit;
+        ++count_;
+    }
+
+    /// Adds eight digits, which are converted at once.
+    inline void AddEight(uint64_t digits) {
+        if (count_ > 10) {
+            Merge();
+        }
+        part_ = part_ * 100000000ull + digits;
+        count_ += 8;
+    }
+
+    inline Int128 Value() {
+        Merge();
+        return value_;
+    }
+
+private:
+    inline void Merge() {
+        if (mulOverflow(value_, POWERS_OF_TEN[count_], &value_) ||
+            addOverflow(value_, Int128(part_), &value_)) {
+            throw AssertionError("value is too big for 128-bit integer");
+        }
+        part_ = 0;
+        count_ = 0;
+    }
+
+    Int128 value_ = 0;
+    uint64_t part_ = 0;
+    size_t count_ = 0;
+};
+
+/// Loads eight chars, the first one is the lowest byte of the result.
+inline uint64_t LoadEightChars(const char* data) {
+    uint64_t result;
+    std::memcpy(&result, data, sizeof(result));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    result = __builtin_bswap64(result);
+#endif
+    return result;
+}
+
+/// Converts eight chars at once (SWAR), returns false if any of them is not a digit.
+inline bool ParseEightDigits(const char* data, uint64_t* result) {
+    uint64_t chars = LoadEightChars(data);
+
+    // Each byte is in '0'..'9', i.e. 0x30..0x39: high nibble is 3 and adding 6 doesn't carry into it.
+    if ((((chars & 0xF0F0F0F0F0F0F0F0ull) | (((chars + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4))
+            != 0x3333333333333333ull)) {
+        return false;
+    }
+
+    chars -= 0x3030303030303030ull;
+    // Pairs, quads and then all eight digits are combined, the first digit is the most significant.
+    chars = (chars * 10 + (chars >> 8)) & 0x00FF00FF00FF00FFull;
+    chars = (chars * 100 + (chars >> 16)) & 0x0000FFFF0000FFFFull;
+    chars = (chars * 10000 + (chars >> 32)) & 0x00000000FFFFFFFFull;
+
+    *result = chars;
+    return true;
+}
+
+inline void ParseDigits(const char* begin, const char* end, DecimalDigits* digits) {
+    uint64_t eight;
+    while (end - begin >= 8 && ParseEightDigits(begin, &eight)) {
+        digits->AddEight(eight);
+        begin += 8;
+    }
+
+    for (; begin != end; ++begin) {
+        if (*begin < '0' || *begin > '9') {
+            throw ValidationError(std::string("unexpected symbol '") + (*begin) + "' in decimal value");
+        }
+        digits->Add(*begin - '0');
+    }
+}
+
+/// Parses value with optional minus sign and fractional part,
+/// digits of the fractional part beyond the scale are dropped.
+Int128 ParseDecimal(std::string_view value, size_t scale) {
+    const char* begin = value.data();
+    const char* end = begin + value.size();
+
+    const bool negative = begin != end && *begin == '-';
+    if (negative) {
+        ++begin;
+    }
+
+    const char* dot = static_cast<const char*>(std::memchr(begin, '.', end - begin));
+    const char* integer_end = dot ? dot : end;
+
+    DecimalDigits digits;
+    ParseDigits(begin, integer_end, &digits);
+
+    size_t fraction_size = 0;
+    if (dot) {
+        fraction_size = std::min<size_t>(end - dot - 1, scale);
+        ParseDigits(dot + 1, dot + 1 + fraction_size, &digits);
+
+        // Dropped digits are checked too.
+        for (const char* c = dot + 1 + fraction_size; c != end; ++c) {
+            if (*c < '0' || *c > '9') {
+                throw ValidationError(std::string("unexpected symbol '") + (*c) + "' in decimal value");
+            }
+        }
+    }
+
+    for (size_t i = fraction_size; i < scale; ++i) {
+        digits.Add(0);
+    }
+
+    const Int128 result = digits.Value();
+    return negative ? -result : result;
+}
+
+template <typename T>
+void AppendParsed(ColumnVector<T>& data, const std::vector<std::string_view>& values, size_t scale) {
+    std::vector<T> parsed(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        parsed[i] = static_cast<T>(ParseDecimal(values[i], scale));
+    }
+    data.AppendMany(parsed.begin(), parsed.end());
+}
+
 }
 
 namespace clickhouse {
@@ -118,74 +260,47 @@ ColumnDecimal::ColumnDecimal(TypeRef type, ColumnRef data)
 }
 
 void ColumnDecimal::Append(const Int128& value) {
-    if (data_->Type()->GetCode() == Type::Int32) {
-        data_->As<ColumnInt32>()->Append(static_cast<ColumnInt32::DataType>(value));
-    } else if (data_->Type()->GetCode() == Type::Int64) {
-        data_->As<ColumnInt64>()->Append(static_cast<ColumnInt64::DataType>(value));
-    } else {
-        data_->As<ColumnInt128>()->Append(static_cast<ColumnInt128::DataType>(value));
+    // Type of storage is known, so it is not checked with dynamic_cast on each row.
+    switch (data_->GetType().GetCode()) {
+        case Type::Int32:
+            static_cast<ColumnInt32&>(*data_).Append(static_cast<ColumnInt32::DataType>(value));
+            break;
+        case Type::Int64:
+            static_cast<ColumnInt64&>(*data_).Append(static_cast<ColumnInt64::DataType>(value));
+            break;
+        default:
+            static_cast<ColumnInt128&>(*data_).Append(static_cast<ColumnInt128::DataType>(value));
+            break;
     }
 }
 
 void ColumnDecimal::Append(const std::string& value) {
-    Int128 int_value = 0;
-    auto c = value.begin();
-    auto end = value.end();
-    bool sign = true;
-    bool has_dot = false;
-
-    size_t zeros = 0;
-
-    while (c != end) {
-        if (*c == '-') {
-            sign = false;
-            if (c != value.begin()) {
-                break;
-            }
-        } else if (*c == '.' && !has_dot) {
-            size_t distance = std::distance(c, end) - 1;
-            auto scale = type_->As<DecimalType>()->GetScale();
-
-            if (distance <= scale) {
-                zeros = scale - distance;
-            } else {
-                std::advance(end, scale - distance);
-            }
-
-            has_dot = true;
-        } else if (*c >= '0' && *c <= '9') {
-            if (mulOverflow(int_value, 10, &int_value) ||
-                addOverflow(int_value, *c - '0', &int_value)) {
-                throw AssertionError("value is too big for 128-bit integer");
-            }
-        } else {
-            throw ValidationError(std::string("unexpected symbol '") + (*c) + "' in decimal value");
-        }
-        ++c;
-    }
-
-    if (c != end) {
-        throw ValidationError("unexpected symbol '-' in decimal value");
-    }
+    Append(ParseDecimal(value, GetScale()));
+}
 
-    while (zeros) {
-        if (mulOverflow(int_value, 10, &int_value)) {
-            throw AssertionError("value is too big for 128-bit integer");
-        }
-        --zeros;
+void ColumnDecimal::AppendFromText(const std::vector<std::string_view>& values) {
+    const size_t scale = GetScale();
+    switch (data_->GetType().GetCode()) {
+        case Type::Int32:
+            AppendParsed(static_cast<ColumnInt32&>(*data_), values, scale);
+            break;
+        case Type::Int64:
+            AppendParsed(static_cast<ColumnInt64&>(*data_), values, scale);
+            break;
+        default:
+            AppendParsed(static_cast<ColumnInt128&>(*data_), values, scale);
+            break;
     }
-
-    Append(sign ? int_value : -int_value);
 }
 
 Int128 ColumnDecimal::At(size_t i) const {
-    switch (data_->Type()->GetCode()) {
+    switch (data_->GetType().GetCode()) {
         case Type::Int32:
-            return static_cast<Int128>(data_->As<ColumnInt32>()->At(i));
+            return static_cast<Int128>(static_cast<const ColumnInt32&>(*data_).At(i));
         case Type::Int64:
-            return static_cast<Int128>(data_->As<ColumnInt64>()->At(i));
+            return static_cast<Int128>(static_cast<const ColumnInt64&>(*data_).At(i));
         case Type::Int128:
-            return data_->As<ColumnInt128>()->At(i);
+            return static_cast<const ColumnInt128&>(*data_).At(i);
         default:
             throw ValidationError("Invalid data_ column type in ColumnDecimal");
     }
@@ -209,6 +324,10 @@ void ColumnDecimal::Clear() {
     data_->Clear();
 }
 
+void ColumnDecimal::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 size_t ColumnDecimal::Size() const {
     return data_->Size();
 }
@@ -218,6 +337,10 @@ ColumnRef ColumnDecimal::Slice(size_t begin, size_t len) const {
     return ColumnRef{new ColumnDecimal(type_, data_->Slice(begin, len))};
 }
 
+ColumnRef ColumnDecimal::Permute(const std::vector<size_t>& indices) const {
+    return ColumnRef{new ColumnDecimal(type_, data_->Permute(indices))};
+}
+
 ColumnRef ColumnDecimal::CloneEmpty() const {
     // coundn't use std::make_shared since this c-tor is private
     return ColumnRef{new ColumnDecimal(type_, data_->CloneEmpty())};
@@ -225,6 +348,10 @@ ColumnRef ColumnDecimal::CloneEmpty() const {
 
 void ColumnDecimal::Swap(Column& other) {
     auto & col = dynamic_cast<ColumnDecimal &>(other);
+    // ColumnDecimalT relies on the type of storage, which must not change.
+    if (data_->Type()->GetCode() != col.data_->Type()->GetCode()) {
+        throw ValidationError("can't swap " + type_->GetName() + " column with " + col.type_->GetName());
+    }
     data_.swap(col.data_);
 }
 
@@ -3,8 +3,13 @@
 #include "column.h"
 #include "numeric.h"
 
+#include <string_view>
+
 namespace clickhouse {
 
+template <typename T>
+class ColumnDecimalT;
+
 /**
  * Represents a column of decimal type.
  */
@@ -17,6 +22,10 @@ public:
     void Append(const Int128& value);
     void Append(const std::string& value);
 
+    /// Parses values, as Append(const std::string&) does, and appends them all at once.
+    /// Digits are converted eight at a time. Nothing is appended, if any value is invalid.
+    void AppendFromText(const std::vector<std::string_view>& values);
+
     Int128 At(size_t i) const;
 
 public:
@@ -24,8 +33,12 @@ public:
     bool LoadBody(InputStream* input, size_t rows) override;
     void SaveBody(OutputStream* output) override;
     void Clear() override;
+
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
     size_t Size() const override;
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
     ItemView GetItem(size_t index) const override;
@@ -34,6 +47,8 @@ public:
     size_t GetPrecision() const;
 
 private:
+    template <typename T> friend class ColumnDecimalT;
+
     /// Depending on a precision it can be one of:
     ///  - ColumnInt32
     ///  - ColumnInt64
@@ -43,4 +58,96 @@ private:
     explicit ColumnDecimal(TypeRef type, ColumnRef data);
 };
 
+/**
+ * Column of decimal type with storage of the given type: int32_t for precision up to 9,
+ * int64_t for up to 18 and Int128 for up to 38. Values are read and written as they are stored,
+ * without conversion to Int128 and without checking the type of storage on each row.
+ */
+template <typename T>
+class ColumnDecimalT : public ColumnDecimal {
+public:
+    using DataType = T;
+    using ValueType = T;
+
+    /// Throws ValidationError, if values of given precision are not stored as T.
+    ColumnDecimalT(size_t precision, size_t scale)
+        : ColumnDecimal(precision, scale)
+    {
+        if (!data_->As<ColumnVector<T>>()) {
+            throw ValidationError("values of " + type_->GetName() + " are stored as " + data_->Type()->GetName());
+        }
+    }
+
+    /// Creates column of the maximal precision for the storage, i.e. Decimal32, Decimal64 or Decimal128.
+    explicit ColumnDecimalT(size_t scale)
+        : ColumnDecimalT(MaxPrecision(), scale)
+    {}
+
+    using ColumnDecimal::Append;
+
+    inline void Append(const T& value) {
+        Data().Append(value);
+    }
+
+    /// Appends values of the container, which are stored as they are.
+    template <typename Container>
+    inline void AppendMany(const Container& container) {
+        Data().AppendMany(std::begin(container), std::end(container));
+    }
+
+    inline T At(size_t i) const {
+        return Data().At(i);
+    }
+
+    inline T operator[](size_t i) const {
+        return Data()[i];
+    }
+
+    /// Returns stored values of all rows.
+    inline const std::vector<T>& GetData() const {
+        return Data().GetData();
+    }
+
+    ColumnRef Slice(size_t begin, size_t len) const override {
+        return ColumnRef{new ColumnDecimalT<T>(type_, Data().Slice(begin, len))};
+    }
+
+    ColumnRef Permute(const std::vector<size_t>& indices) const override {
+        return ColumnRef{new ColumnDecimalT<T>(type_, Data().Permute(indices))};
+    }
+
+    ColumnRef CloneEmpty() const override {
+        return ColumnRef{new ColumnDecimalT<T>(type_, std::make_shared<ColumnVector<T>>())};
+    }
+
+private:
+    ColumnDecimalT(TypeRef type, ColumnRef data)
+        : ColumnDecimal(type, data)
+    {}
+
+    /// data_ is always ColumnVector<T>: it is checked on construction and ColumnDecimal::Swap()
+    /// exchanges storage of the same type only.
+    inline ColumnVector<T>& Data() {
+        return static_cast<ColumnVector<T>&>(*data_);
+    }
+
+    inline const ColumnVector<T>& Data() const {
+        return static_cast<const ColumnVector<T>&>(*data_);
+    }
+
+    static constexpr size_t MaxPrecision() {
+        if constexpr (sizeof(T) == 4) {
+            return 9;
+        } else if constexpr (sizeof(T) == 8) {
+            return 18;
+        } else {
+            return 38;
+        }
+    }
+};
+
+using ColumnDecimal32  = ColumnDecimalT<int32_t>;
+using ColumnDecimal64  = ColumnDecimalT<int64_t>;
+using ColumnDecimal128 = ColumnDecimalT<Int128>;
+
 }
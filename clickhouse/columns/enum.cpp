@@ -38,6 +38,11 @@ void ColumnEnum<T>::Clear() {
     data_.clear();
 }
 
+template <typename T>
+void ColumnEnum<T>::Reserve(size_t new_cap) {
+    data_.reserve(new_cap);
+}
+
 template <typename T>
 const T& ColumnEnum<T>::At(size_t n) const {
     return data_.at(n);
@@ -94,6 +99,19 @@ ColumnRef ColumnEnum<T>::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnEnum<T>>(type_, SliceVector(data_, begin, len));
 }
 
+template <typename T>
+ColumnRef ColumnEnum<T>::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    auto result = std::make_shared<ColumnEnum<T>>(type_);
+    result->data_.resize(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        result->data_[i] = data_[indices[i]];
+    }
+
+    return result;
+}
+
 template <typename T>
 ColumnRef ColumnEnum<T>::CloneEmpty() const {
     return std::make_shared<ColumnEnum<T>>(type_);
@@ -27,6 +27,16 @@
 namespace clickhouse {
 namespace {
 
+/// Decimal column with typed storage for the precision.
+static ColumnRef CreateDecimalColumn(size_t precision, size_t scale) {
+    if (precision <= 9) {
+        return std::make_shared<ColumnDecimal32>(precision, scale);
+    } else if (precision <= 18) {
+        return std::make_shared<ColumnDecimal64>(precision, scale);
+    }
+    return std::make_shared<ColumnDecimal128>(precision, scale);
+}
+
 static ColumnRef CreateTerminalColumn(const TypeAst& ast) {
     switch (ast.code) {
     case Type::Void:
@@ -58,13 +68,13 @@ static ColumnRef CreateTerminalColumn(const TypeAst& ast) {
         return std::make_shared<ColumnFloat64>();
 
     case Type::Decimal:
-        return std::make_shared<ColumnDecimal>(ast.elements.front().value, ast.elements.back().value);
+        return CreateDecimalColumn(ast.elements.front().value, ast.elements.back().value);
     case Type::Decimal32:
-        return std::make_shared<ColumnDecimal>(9, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal32>(ast.elements.front().value);
     case Type::Decimal64:
-        return std::make_shared<ColumnDecimal>(18, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal64>(ast.elements.front().value);
     case Type::Decimal128:
-        return std::make_shared<ColumnDecimal>(38, ast.elements.front().value);
+        return std::make_shared<ColumnDecimal128>(ast.elements.front().value);
 
     case Type::String:
         return std::make_shared<ColumnString>();
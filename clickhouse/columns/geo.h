@@ -41,6 +41,9 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
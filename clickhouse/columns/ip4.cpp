@@ -38,6 +38,10 @@ void ColumnIPv4::Clear() {
     data_->Clear();
 }
 
+void ColumnIPv4::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 in_addr ColumnIPv4::At(size_t n) const {
     in_addr addr;
     addr.s_addr = ntohl(data_->At(n));
@@ -87,6 +91,10 @@ ColumnRef ColumnIPv4::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnIPv4>(data_->Slice(begin, len));
 }
 
+ColumnRef ColumnIPv4::Permute(const std::vector<size_t>& indices) const {
+    return std::make_shared<ColumnIPv4>(data_->Permute(indices));
+}
+
 ColumnRef ColumnIPv4::CloneEmpty() const {
     return std::make_shared<ColumnIPv4>(data_->CloneEmpty());
 }
@@ -49,11 +49,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -42,6 +42,10 @@ void ColumnIPv6::Clear() {
     data_->Clear();
 }
 
+void ColumnIPv6::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 std::string ColumnIPv6::AsString (size_t n) const {
     const auto& addr = this->At(n);
 
@@ -87,6 +91,10 @@ ColumnRef ColumnIPv6::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnIPv6>(data_->Slice(begin, len));
 }
 
+ColumnRef ColumnIPv6::Permute(const std::vector<size_t>& indices) const {
+    return std::make_shared<ColumnIPv6>(data_->Permute(indices));
+}
+
 ColumnRef ColumnIPv6::CloneEmpty() const {
     return std::make_shared<ColumnIPv6>(data_->CloneEmpty());
 }
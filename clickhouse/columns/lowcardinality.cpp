@@ -6,7 +6,6 @@
 
 #include <cityhash/city.h>
 
-#include <functional>
 #include <string_view>
 #include <type_traits>
 
@@ -94,6 +93,49 @@ inline auto VisitIndexColumn(Vizitor && vizitor, ColumnType && col) {
     }
 }
 
+// Narrowest type of index, which can address all items of the dictionary.
+IndexType indexTypeForDictionarySize(uint64_t size) {
+    if (size <= (1ull << 8))
+        return IndexType::UInt8;
+    if (size <= (1ull << 16))
+        return IndexType::UInt16;
+    if (size <= (1ull << 32))
+        return IndexType::UInt32;
+    return IndexType::UInt64;
+}
+
+// Copies indices into a column of another type, which must fit all of them.
+template <typename ResultColumnType>
+ColumnRef convertIndexColumn(const Column & index_column) {
+    using ValueType = typename ResultColumnType::ValueType;
+
+    return VisitIndexColumn([](const auto & source) -> ColumnRef {
+        const auto & data = source.GetData();
+
+        std::vector<ValueType> values;
+        values.reserve(data.capacity());
+        for (const auto value : data) {
+            values.push_back(static_cast<ValueType>(value));
+        }
+        return std::make_shared<ResultColumnType>(std::move(values));
+    }, index_column);
+}
+
+ColumnRef convertIndexColumn(const Column & index_column, IndexType type) {
+    switch (type) {
+        case IndexType::UInt8:
+            return convertIndexColumn<ColumnUInt8>(index_column);
+        case IndexType::UInt16:
+            return convertIndexColumn<ColumnUInt16>(index_column);
+        case IndexType::UInt32:
+            return convertIndexColumn<ColumnUInt32>(index_column);
+        case IndexType::UInt64:
+            return convertIndexColumn<ColumnUInt64>(index_column);
+    }
+
+    throw ValidationError("Invalid LowCardinality index type value: " + std::to_string(static_cast<uint64_t>(type)));
+}
+
 // A special NULL-item, which is expected at pos(0) in dictionary,
 // note that we distinguish empty string from NULL-value.
 inline auto GetNullItemForDictionary(const ColumnRef dictionary) {
@@ -114,6 +156,23 @@ inline ItemView GetDefaultItemForDictionary(const ColumnRef dictionary) {
     }
 }
 
+// Trailing zeroes of FixedString values are padding, so "ab" and "ab\0" is the same value.
+inline std::string_view GetComparableData(const ItemView & item) {
+    auto data = item.data;
+    if (item.type == Type::FixedString) {
+        while (!data.empty() && data.back() == '\0') {
+            data.remove_suffix(1);
+        }
+    }
+    return data;
+}
+
+inline bool IsSameItem(const ItemView & left, const ItemView & right) {
+    // NULL of ColumnNullable is distinct from the empty string.
+    return (left.type == Type::Void) == (right.type == Type::Void)
+        && GetComparableData(left) == GetComparableData(right);
+}
+
 void AppendToDictionary(Column& dictionary, const ItemView & item);
 
 inline void AppendNullableToDictionary(ColumnNullable& nullable, const ItemView & item) {
@@ -154,18 +213,79 @@ inline void AppendToDictionary(Column& dictionary, const ItemView & item) {
 }
 
 namespace clickhouse {
+
+namespace details {
+
+namespace {
+
+constexpr size_t INITIAL_UNIQUE_ITEMS_CAPACITY = 16;
+
+}
+
+LowCardinalityUniqueItems::LowCardinalityUniqueItems()
+    : cells_(INITIAL_UNIQUE_ITEMS_CAPACITY, Cell{0, EMPTY})
+    , size_(0)
+{
+}
+
+void LowCardinalityUniqueItems::Insert(size_t pos, std::uint64_t hash, std::uint64_t index) {
+    cells_[pos] = Cell{hash, index};
+    ++size_;
+}
+
+void LowCardinalityUniqueItems::ReserveForInsert() {
+    Reserve(size_ + 1);
+}
+
+void LowCardinalityUniqueItems::Reserve(size_t new_cap) {
+    // Load factor is kept not greater than 1/2, so probe sequences stay short.
+    if (new_cap * 2 <= cells_.size()) {
+        return;
+    }
+
+    size_t capacity = cells_.size();
+    while (capacity < new_cap * 2) {
+        capacity *= 2;
+    }
+
+    std::vector<Cell> old_cells(capacity, Cell{0, EMPTY});
+    old_cells.swap(cells_);
+
+    const size_t mask = cells_.size() - 1;
+    for (const auto & cell : old_cells) {
+        if (cell.index != EMPTY) {
+            size_t pos = cell.hash & mask;
+            while (cells_[pos].index != EMPTY) {
+                pos = (pos + 1) & mask;
+            }
+            cells_[pos] = cell;
+        }
+    }
+}
+
+void LowCardinalityUniqueItems::Clear() {
+    cells_.assign(INITIAL_UNIQUE_ITEMS_CAPACITY, Cell{0, EMPTY});
+    size_ = 0;
+}
+
+}
+
 ColumnLowCardinality::ColumnLowCardinality(ColumnRef dictionary_column)
     : Column(Type::CreateLowCardinality(dictionary_column->Type())),
       dictionary_column_(dictionary_column->CloneEmpty()), // safe way to get an column of the same type.
-      index_column_(std::make_shared<ColumnUInt32>())
+      index_column_(createIndexColumn(IndexType::UInt8))
 {
+    // Nullable dictionary may come as ColumnRef too, e.g. from CloneEmpty().
+    if (dictionary_column_->As<ColumnNullable>()) {
+        AppendNullItem();
+    }
     Setup(dictionary_column);
 }
 
 ColumnLowCardinality::ColumnLowCardinality(std::shared_ptr<ColumnNullable> dictionary_column)
     : Column(Type::CreateLowCardinality(dictionary_column->Type())),
       dictionary_column_(dictionary_column->CloneEmpty()), // safe way to get an column of the same type.
-      index_column_(std::make_shared<ColumnUInt32>())
+      index_column_(createIndexColumn(IndexType::UInt8))
 {
     AppendNullItem();
     Setup(dictionary_column);
@@ -197,7 +317,12 @@ std::uint64_t ColumnLowCardinality::getDictionaryIndex(std::uint64_t item_index)
 }
 
 void ColumnLowCardinality::appendIndex(std::uint64_t item_index) {
-    // TODO (nemkov): handle case when index should go from UInt8 to UInt16, etc.
+    // Index column is widened as the dictionary grows, as ClickHouse does.
+    const auto required_type = indexTypeForDictionarySize(item_index + 1);
+    if (required_type > indexTypeFromIndexColumn(*index_column_)) {
+        index_column_ = convertIndexColumn(*index_column_, required_type);
+    }
+
     VisitIndexColumn([item_index](auto & arg) {
         arg.Append(item_index);
     }, *index_column_);
@@ -209,17 +334,14 @@ void ColumnLowCardinality::removeLastIndex() {
     }, *index_column_);
 }
 
-details::LowCardinalityHashKey ColumnLowCardinality::computeHashKey(const ItemView & item) {
-    static const auto hasher = std::hash<ItemView::DataType>{};
+std::uint64_t ColumnLowCardinality::computeHashKey(const ItemView & item) {
     if (item.type == Type::Void) {
-        // to distinguish NULL of ColumnNullable and empty string.
-        return {0u, 0u};
+        // NULL of ColumnNullable, items are distinguished from the empty string upon comparison.
+        return 0u;
     }
 
-    const auto hash1 = hasher(item.data);
-    const auto hash2 = CityHash64(item.data.data(), item.data.size());
-
-    return details::LowCardinalityHashKey{hash1, hash2};
+    const auto data = GetComparableData(item);
+    return CityHash64(data.data(), data.size());
 }
 
 ColumnRef ColumnLowCardinality::GetDictionary() {
@@ -238,64 +360,99 @@ void ColumnLowCardinality::Append(ColumnRef col) {
 
 namespace {
 
-auto Load(ColumnRef new_dictionary_column, InputStream& input, size_t rows) {
+ColumnRef LoadKeys(const ColumnRef& keys_column, InputStream& input) {
+    uint64_t number_of_keys;
+    if (!WireFormat::ReadFixed(input, &number_of_keys))
+        throw ProtocolError("Failed to read number of rows in dictionary column.");
+
+    auto keys = keys_column->CloneEmpty();
+    if (!keys->LoadBody(&input, number_of_keys))
+        throw ProtocolError("Failed to read values of dictionary column.");
+
+    return keys;
+}
+
+/// Dictionary and indices of rows of a granule.
+struct Granule {
+    ColumnRef dictionary;
+    ColumnRef index;
+};
+
+std::vector<Granule> Load(ColumnRef dictionary_column, InputStream& input, size_t rows) {
     // This code tries to follow original implementation of ClickHouse's LowCardinality serialization with
     // NativeBlockOutputStream::writeData() for DataTypeLowCardinality
-    // (see corresponding serializeBinaryBulkStateSuffix, serializeBinaryBulkStatePrefix, and serializeBinaryBulkWithMultipleStreams),
-    // but with certain simplifications: no shared dictionaries, no on-the-fly dictionary updates.
+    // (see corresponding serializeBinaryBulkStateSuffix, serializeBinaryBulkStatePrefix, and serializeBinaryBulkWithMultipleStreams).
     //
-    // As for now those features are not used in client-server protocol and minimal implementation suffices,
-    // however some day they may.
+    // Rows may be split into granules, each one with its own index type. A granule refers to the global dictionary,
+    // which is sent before the first granule and may be replaced before any other one, and/or to its own additional keys.
+    // Indices of additional keys follow indices of the global dictionary.
+    // Global dictionary is not kept between columns: ClickHouse starts a new one for each column of each block.
+
+    auto keys_column = dictionary_column;
+    if (auto nullable = dictionary_column->As<ColumnNullable>()) {
+        keys_column = nullable->Nested();
+    }
 
-    uint64_t index_serialization_type;
-    if (!WireFormat::ReadFixed(input, &index_serialization_type))
-        throw ProtocolError("Failed to read index serializaton type.");
+    ColumnRef global_dictionary;
+    std::vector<Granule> granules;
 
-    auto new_index_column = createIndexColumn(static_cast<IndexType>(index_serialization_type & IndexTypeMask));
-    if (index_serialization_type & IndexFlag::NeedGlobalDictionaryBit)
-        throw UnimplementedError("Global dictionary is not supported.");
+    for (size_t rows_read = 0; rows_read < rows || granules.empty(); ) {
+        uint64_t index_serialization_type;
+        if (!WireFormat::ReadFixed(input, &index_serialization_type))
+            throw ProtocolError("Failed to read index serializaton type.");
 
-    if ((index_serialization_type & IndexFlag::HasAdditionalKeysBit) == 0)
-        throw ValidationError("HasAdditionalKeysBit is missing.");
+        auto index_column = createIndexColumn(static_cast<IndexType>(index_serialization_type & IndexTypeMask));
 
-    uint64_t number_of_keys;
-    if (!WireFormat::ReadFixed(input, &number_of_keys))
-        throw ProtocolError("Failed to read number of rows in dictionary column.");
+        const bool need_global_dictionary = index_serialization_type & IndexFlag::NeedGlobalDictionaryBit;
+        const bool has_additional_keys = index_serialization_type & IndexFlag::HasAdditionalKeysBit;
 
-    auto dataColumn = new_dictionary_column;
-    if (auto nullable = new_dictionary_column->As<ColumnNullable>()) {
-        dataColumn = nullable->Nested();
-    }
+        if (!need_global_dictionary && !has_additional_keys)
+            throw ValidationError("HasAdditionalKeysBit is missing.");
 
-    if (!dataColumn->LoadBody(&input, number_of_keys))
-        throw ProtocolError("Failed to read values of dictionary column.");
+        if (need_global_dictionary && (!global_dictionary || (index_serialization_type & IndexFlag::NeedUpdateDictionary))) {
+            global_dictionary = LoadKeys(keys_column, input);
+        }
+
+        ColumnRef keys;
+        if (has_additional_keys) {
+            keys = LoadKeys(keys_column, input);
+            if (need_global_dictionary) {
+                auto all_keys = global_dictionary->Slice(0, global_dictionary->Size());
+                all_keys->Append(keys);
+                keys = all_keys;
+            }
+        } else {
+            keys = global_dictionary;
+        }
 
-    uint64_t number_of_rows;
-    if (!WireFormat::ReadFixed(input, &number_of_rows))
-        throw ProtocolError("Failed to read number of rows in index column.");
+        uint64_t number_of_rows;
+        if (!WireFormat::ReadFixed(input, &number_of_rows))
+            throw ProtocolError("Failed to read number of rows in index column.");
 
-    if (number_of_rows != rows)
-        throw AssertionError("LowCardinality column must be read in full.");
+        if (number_of_rows > rows - rows_read)
+            throw AssertionError("LowCardinality column must be read in full.");
 
-    new_index_column->LoadBody(&input, number_of_rows);
+        if (!index_column->LoadBody(&input, number_of_rows))
+            throw ProtocolError("Failed to read indices of LowCardinality column.");
 
-    if (auto nullable = new_dictionary_column->As<ColumnNullable>()) {
-        nullable->Append(true);
-        for(std::size_t i = 1; i < dataColumn->Size(); i++) {
-            nullable->Append(false);
+        ColumnRef dictionary = keys;
+        if (auto nullable = dictionary_column->As<ColumnNullable>()) {
+            auto nulls = std::make_shared<ColumnUInt8>();
+            nulls->Append(1);
+            for (std::size_t i = 1; i < keys->Size(); i++) {
+                nulls->Append(0);
+            }
+            dictionary = std::make_shared<ColumnNullable>(keys, nulls);
         }
-    }
 
-    ColumnLowCardinality::UniqueItems new_unique_items_map;
-    for (size_t i = 0; i < dataColumn->Size(); ++i) {
-        const auto key = ColumnLowCardinality::computeHashKey(new_dictionary_column->GetItem(i));
-        new_unique_items_map.emplace(key, i);
+        granules.push_back(Granule{dictionary, index_column});
+        rows_read += number_of_rows;
     }
 
     // suffix
     // NOP
 
-    return std::make_tuple(new_dictionary_column, new_index_column, new_unique_items_map);
+    return granules;
 }
 
 }
@@ -314,11 +471,26 @@ bool ColumnLowCardinality::LoadPrefix(InputStream* input, size_t) {
 
 bool ColumnLowCardinality::LoadBody(InputStream* input, size_t rows) {
     try {
-        auto [new_dictionary, new_index, new_unique_items_map] = ::Load(dictionary_column_->CloneEmpty(), *input, rows);
-
-        dictionary_column_->Swap(*new_dictionary);
-        index_column_.swap(new_index);
-        unique_items_map_.swap(new_unique_items_map);
+        auto granules = ::Load(dictionary_column_->CloneEmpty(), *input, rows);
+
+        if (granules.size() == 1) {
+            dictionary_column_->Swap(*granules.front().dictionary);
+            index_column_.swap(granules.front().index);
+            // Loaded columns are mostly only read, so unique items are found on the first append.
+            unique_items_map_.Clear();
+        } else {
+            // Granules have different dictionaries, which are merged.
+            auto result = std::make_shared<ColumnLowCardinality>(dictionary_column_->CloneEmpty());
+            for (auto & granule : granules) {
+                auto part = std::make_shared<ColumnLowCardinality>(dictionary_column_->CloneEmpty());
+                // Granules may share the same global dictionary, so it is not swapped.
+                part->dictionary_column_ = granule.dictionary;
+                part->index_column_ = granule.index;
+                part->unique_items_map_.Clear();
+                result->Append(part);
+            }
+            Swap(*result);
+        }
 
         return true;
     } catch (...) {
@@ -332,7 +504,14 @@ void ColumnLowCardinality::SavePrefix(OutputStream* output) {
 }
 
 void ColumnLowCardinality::SaveBody(OutputStream* output) {
-    const uint64_t index_serialization_type = indexTypeFromIndexColumn(*index_column_) | IndexFlag::HasAdditionalKeysBit;
+    // Index column may be wider than needed, if it was loaded or dictionary was compacted.
+    auto index_column = index_column_;
+    const auto required_type = indexTypeForDictionarySize(dictionary_column_->Size());
+    if (required_type < indexTypeFromIndexColumn(*index_column)) {
+        index_column = convertIndexColumn(*index_column, required_type);
+    }
+
+    const uint64_t index_serialization_type = indexTypeFromIndexColumn(*index_column) | IndexFlag::HasAdditionalKeysBit;
     WireFormat::WriteFixed(*output, index_serialization_type);
 
     const uint64_t number_of_keys = dictionary_column_->Size();
@@ -344,16 +523,16 @@ void ColumnLowCardinality::SaveBody(OutputStream* output) {
         dictionary_column_->SaveBody(output);
     }
 
-    const uint64_t number_of_rows = index_column_->Size();
+    const uint64_t number_of_rows = index_column->Size();
     WireFormat::WriteFixed(*output, number_of_rows);
 
-    index_column_->SaveBody(output);
+    index_column->SaveBody(output);
 }
 
 void ColumnLowCardinality::Clear() {
-    index_column_->Clear();
+    index_column_ = createIndexColumn(IndexType::UInt8);
     dictionary_column_->Clear();
-    unique_items_map_.clear();
+    unique_items_map_.Clear();
 
     if (auto columnNullable = dictionary_column_->As<ColumnNullable>()) {
         AppendNullItem();
@@ -361,6 +540,10 @@ void ColumnLowCardinality::Clear() {
     AppendDefaultItem();
 }
 
+void ColumnLowCardinality::Reserve(size_t new_cap) {
+    index_column_->Reserve(new_cap);
+}
+
 size_t ColumnLowCardinality::Size() const {
     return index_column_->Size();
 }
@@ -377,6 +560,18 @@ ColumnRef ColumnLowCardinality::Slice(size_t begin, size_t len) const {
     return result;
 }
 
+ColumnRef ColumnLowCardinality::Permute(const std::vector<size_t>& indices) const {
+    auto result = std::make_shared<ColumnLowCardinality>(dictionary_column_->CloneEmpty());
+
+    // Only indices are permuted, dictionary is copied as is.
+    result->dictionary_column_ = dictionary_column_->Slice(0, dictionary_column_->Size());
+    result->index_column_ = index_column_->Permute(indices);
+    // Unique items are found on the first append, if there is any.
+    result->unique_items_map_.Clear();
+
+    return result;
+}
+
 ColumnRef ColumnLowCardinality::CloneEmpty() const {
     return std::make_shared<ColumnLowCardinality>(dictionary_column_->CloneEmpty());
 }
@@ -392,7 +587,7 @@ void ColumnLowCardinality::Swap(Column& other) {
     dictionary_column_->Swap(*col.dictionary_column_);
 
     index_column_.swap(col.index_column_);
-    unique_items_map_.swap(col.unique_items_map_);
+    std::swap(unique_items_map_, col.unique_items_map_);
 }
 
 ItemView ColumnLowCardinality::GetItem(size_t index) const {
@@ -411,44 +606,183 @@ ItemView ColumnLowCardinality::GetItem(size_t index) const {
 
 // No checks regarding value type or validity of value is made.
 void ColumnLowCardinality::AppendUnsafe(const ItemView & value) {
-    const auto key = computeHashKey(value);
-    const auto initial_index_size = index_column_->Size();
-    // If the value is unique, then we are going to append it to a dictionary, hence new index is Size().
-    auto [iterator, is_new_item] = unique_items_map_.try_emplace(key, dictionary_column_->Size());
-    try {
-        // Order is important, adding to dictionary last, since it is much (MUCH!!!!) harder
-        // to remove item from dictionary column than from index column
-        // (also, there is currently no API to do that).
-        // Hence in catch-block we assume that dictionary wasn't modified on exception
-        // and there is nothing to rollback.
-
-        appendIndex(iterator->second);
-        if (is_new_item) {
-            AppendToDictionary(*dictionary_column_, value);
+    // If adding of the index fails, the new item stays in the dictionary unused,
+    // which is much simpler than removing it from the dictionary column.
+    appendIndex(FindOrAddToDictionary(value));
+}
+
+std::uint64_t ColumnLowCardinality::FindOrAddToDictionary(const ItemView & value) {
+    // Dictionary is never empty, so empty map means that it was not built yet.
+    if (unique_items_map_.Size() == 0 && dictionary_column_->Size() != 0) {
+        BuildUniqueItemsMap();
+    }
+
+    const auto hash = computeHashKey(value);
+
+    unique_items_map_.ReserveForInsert();
+    const auto pos = unique_items_map_.Find(hash, [&](std::uint64_t index) {
+        return IsSameItem(dictionary_column_->GetItem(index), value);
+    });
+
+    auto index = unique_items_map_.IndexAt(pos);
+    if (index == UniqueItems::EMPTY) {
+        // Dictionary is modified first: if that fails, there is nothing to roll back.
+        index = dictionary_column_->Size();
+        AppendToDictionary(*dictionary_column_, value);
+        unique_items_map_.Insert(pos, hash, index);
+    }
+
+    return index;
+}
+
+void ColumnLowCardinality::AppendFrom(const Column& column) {
+    if (auto lc = dynamic_cast<const ColumnLowCardinality*>(&column)) {
+        if (!dictionary_column_->Type()->IsEqual(lc->dictionary_column_->Type()))
+            throw ValidationError("Can't append " + column.Type()->GetName() + " to " + Type()->GetName());
+
+        for (size_t i = 0; i < lc->Size(); ++i) {
+            AppendUnsafe(lc->GetItem(i));
+        }
+        return;
+    }
+
+    auto values_type = column.Type();
+    if (values_type->GetCode() == Type::Nullable) {
+        if (!dictionary_column_->As<ColumnNullable>())
+            throw ValidationError("Can't append " + column.Type()->GetName() + " to " + Type()->GetName());
+        values_type = values_type->As<NullableType>()->GetNestedType();
+    }
+
+    const auto dictionary_nullable = dictionary_column_->As<ColumnNullable>();
+    const auto dictionary_type = dictionary_nullable ? dictionary_nullable->Nested()->Type() : dictionary_column_->Type();
+    if (!values_type->IsEqual(dictionary_type))
+        throw ValidationError("Can't append " + column.Type()->GetName() + " to " + Type()->GetName());
+
+    switch (dictionary_type->GetCode()) {
+        case Type::String:
+            return AppendFromImpl<ColumnString>(column);
+        case Type::FixedString:
+            return AppendFromImpl<ColumnFixedString>(column);
+        default:
+            throw ValidationError("Unexpected dictionary column type: " + dictionary_type->GetName());
+    }
+}
+
+template <typename ValuesColumnType>
+void ColumnLowCardinality::AppendFromImpl(const Column& column) {
+    constexpr size_t BATCH_SIZE = 256;
+    constexpr bool is_fixed_string = std::is_same_v<ValuesColumnType, ColumnFixedString>;
+
+    // Null map of values, if they are Nullable.
+    const ColumnUInt8* nulls = nullptr;
+    ColumnRef values_column;
+    if (auto nullable = dynamic_cast<const ColumnNullable*>(&column)) {
+        nulls = nullable->Nulls()->As<ColumnUInt8>().get();
+        values_column = nullable->Nested();
+    }
+    const auto & values = values_column ? dynamic_cast<const ValuesColumnType&>(*values_column) : dynamic_cast<const ValuesColumnType&>(column);
+
+    // Dictionary is compared directly with values, not with items of ColumnNullable.
+    const auto dictionary_nullable = dictionary_column_->As<ColumnNullable>();
+    const auto & dictionary = dynamic_cast<const ValuesColumnType&>(dictionary_nullable ? *dictionary_nullable->Nested() : *dictionary_column_);
+    // Index of the null item is 0, no other item may be found there.
+    const size_t first_item = dictionary_nullable ? 1 : 0;
+    const auto type_code = dictionary.Type()->GetCode();
+
+    if (unique_items_map_.Size() == 0 && dictionary_column_->Size() != 0) {
+        BuildUniqueItemsMap();
+    }
+
+    auto comparable = [](std::string_view data) {
+        if constexpr (is_fixed_string) {
+            while (!data.empty() && data.back() == '\0') {
+                data.remove_suffix(1);
+            }
         }
+        return data;
+    };
+
+    const size_t rows = values.Size();
+    std::vector<std::uint64_t> indices(rows);
+    std::uint64_t hashes[BATCH_SIZE];
+
+    for (size_t begin = 0; begin < rows; begin += BATCH_SIZE) {
+        const size_t end = std::min(rows, begin + BATCH_SIZE);
+
+        // Hashes of the batch are computed first, so cells of the table are prefetched
+        // long before they are looked up.
+        for (size_t i = begin; i < end; ++i) {
+            const auto data = comparable(values[i]);
+            hashes[i - begin] = CityHash64(data.data(), data.size());
+            unique_items_map_.Prefetch(hashes[i - begin]);
+        }
+
+        for (size_t i = begin; i < end; ++i) {
+            if (nulls && (*nulls)[i]) {
+                indices[i] = 0;
+                continue;
+            }
+
+            const auto value = values[i];
+            const auto data = comparable(value);
+            const auto hash = hashes[i - begin];
+
+            unique_items_map_.ReserveForInsert();
+            const auto pos = unique_items_map_.Find(hash, [&](std::uint64_t index) {
+                return index >= first_item && comparable(dictionary[index]) == data;
+            });
+
+            auto index = unique_items_map_.IndexAt(pos);
+            if (index == UniqueItems::EMPTY) {
+                index = dictionary_column_->Size();
+                AppendToDictionary(*dictionary_column_, ItemView{type_code, value});
+                unique_items_map_.Insert(pos, hash, index);
+            }
+            indices[i] = index;
+        }
+    }
+
+    // Index column is widened once for all new items.
+    const auto required_type = indexTypeForDictionarySize(dictionary_column_->Size());
+    if (required_type > indexTypeFromIndexColumn(*index_column_)) {
+        index_column_ = convertIndexColumn(*index_column_, required_type);
     }
-    catch (...) {
-        if (index_column_->Size() != initial_index_size)
-            removeLastIndex();
-        if (is_new_item)
-            unique_items_map_.erase(iterator);
 
-        throw;
+    VisitIndexColumn([&indices](auto & arg) {
+        using ValueType = typename std::decay_t<decltype(arg)>::ValueType;
+        arg.Reserve(arg.Size() + indices.size());
+        for (const auto index : indices) {
+            arg.Append(static_cast<ValueType>(index));
+        }
+    }, *index_column_);
+}
+
+void ColumnLowCardinality::BuildUniqueItemsMap() {
+    unique_items_map_.Clear();
+    unique_items_map_.Reserve(dictionary_column_->Size());
+
+    for (size_t i = 0; i < dictionary_column_->Size(); ++i) {
+        const auto item = dictionary_column_->GetItem(i);
+        const auto hash = computeHashKey(item);
+
+        const auto pos = unique_items_map_.Find(hash, [&](std::uint64_t index) {
+            return IsSameItem(dictionary_column_->GetItem(index), item);
+        });
+        // Keep the first one of duplicates, if there are any.
+        if (unique_items_map_.IndexAt(pos) == UniqueItems::EMPTY) {
+            unique_items_map_.Insert(pos, hash, i);
+        }
     }
 }
 
 void ColumnLowCardinality::AppendNullItem()
 {
-    const auto null_item = GetNullItemForDictionary(dictionary_column_);
-    AppendToDictionary(*dictionary_column_, null_item);
-    unique_items_map_.emplace(computeHashKey(null_item), 0);
+    FindOrAddToDictionary(GetNullItemForDictionary(dictionary_column_));
 }
 
 void ColumnLowCardinality::AppendDefaultItem()
 {
-    const auto defaultItem = GetDefaultItemForDictionary(dictionary_column_);
-    unique_items_map_.emplace(computeHashKey(defaultItem), dictionary_column_->Size());
-    AppendToDictionary(*dictionary_column_, defaultItem);
+    FindOrAddToDictionary(GetDefaultItemForDictionary(dictionary_column_));
 }
 
 size_t ColumnLowCardinality::GetDictionarySize() const {
@@ -4,10 +4,9 @@
 #include "numeric.h"
 #include "nullable.h"
 
-#include <functional>
 #include <string>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace clickhouse {
 
@@ -16,19 +15,67 @@ class ColumnLowCardinalityT;
 
 namespace details {
 
-/** LowCardinalityHashKey used as key in unique items hashmap to abstract away key value
- * (type of which depends on dictionary column) and to reduce likelehood of collisions.
+/** Open-addressing hash table of unique items of LowCardinality dictionary.
  *
- * In order to dramatically reduce collision rate, we use 2 different hashes from 2 different hash functions.
- * First hash is used in hashtable (to calculate item position).
- * Second one is used as part of key value and accessed via `operator==()` upon collision resolution/detection.
+ * Cells keep only the hash of an item and its index in the dictionary. Upon hash match the item
+ * is compared with the one in the dictionary, so different items are never confused.
  */
-using LowCardinalityHashKey = std::pair<std::uint64_t, std::uint64_t>;
+class LowCardinalityUniqueItems {
+public:
+    static constexpr std::uint64_t EMPTY = ~std::uint64_t(0);
+
+    LowCardinalityUniqueItems();
+
+    /// Returns position of the cell of the item, or of the empty cell, where it may be inserted.
+    /// `equals(index)` tells whether the item is the one at `index` in the dictionary.
+    template <typename Equals>
+    size_t Find(std::uint64_t hash, Equals && equals) const {
+        const size_t mask = cells_.size() - 1;
+        for (size_t pos = hash & mask; ; pos = (pos + 1) & mask) {
+            const auto & cell = cells_[pos];
+            if (cell.index == EMPTY || (cell.hash == hash && equals(cell.index))) {
+                return pos;
+            }
+        }
+    }
+
+    /// Hints that the item with the hash is going to be looked up soon.
+    inline void Prefetch(std::uint64_t hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&cells_[hash & (cells_.size() - 1)]);
+#else
+        (void)hash;
+#endif
+    }
+
+    /// Index of the item in the cell returned by Find(), EMPTY if the item was not found.
+    inline std::uint64_t IndexAt(size_t pos) const {
+        return cells_[pos].index;
+    }
+
+    /// Inserts the item into the empty cell returned by Find().
+    void Insert(size_t pos, std::uint64_t hash, std::uint64_t index);
+
+    /// Grows the table, so one more item may be inserted. Positions returned by Find() before are invalidated.
+    void ReserveForInsert();
 
-struct LowCardinalityHashKeyHash {
-    inline std::size_t operator()(const LowCardinalityHashKey &hash_key) const noexcept {
-        return hash_key.first;
+    /// Grows the table, so `new_cap` items may be stored.
+    void Reserve(size_t new_cap);
+
+    void Clear();
+
+    inline size_t Size() const {
+        return size_;
     }
+
+private:
+    struct Cell {
+        std::uint64_t hash;
+        std::uint64_t index;
+    };
+
+    std::vector<Cell> cells_;
+    size_t size_;
 };
 
 }
@@ -40,7 +87,7 @@ struct LowCardinalityHashKeyHash {
  * */
 class ColumnLowCardinality : public Column {
 public:
-    using UniqueItems = std::unordered_map<details::LowCardinalityHashKey, size_t /*dictionary index*/, details::LowCardinalityHashKeyHash>;
+    using UniqueItems = details::LowCardinalityUniqueItems;
 
     template <typename T>
     friend class ColumnLowCardinalityT;
@@ -50,6 +97,7 @@ private:
     // so make sure to NOT change address of the dictionary object (with reset(), swap()) or with anything else.
     ColumnRef dictionary_column_;
     ColumnRef index_column_;
+    // Empty for loaded and permuted columns until the first append.
     UniqueItems unique_items_map_;
 
 public:
@@ -61,6 +109,11 @@ public:
     /// Appends another LowCardinality column to the end of this one, updating dictionary.
     void Append(ColumnRef /*column*/) override;
 
+    /// Appends all values of a plain column of the dictionary type (e.g. String for LowCardinality(String)),
+    /// or of its nested type for LowCardinality(Nullable(T)). Values are hashed and looked up in batches,
+    /// which is much faster than appending them one by one.
+    void AppendFrom(const Column& column);
+
     bool LoadPrefix(InputStream* input, size_t rows) override;
 
     /// Loads column data from input stream.
@@ -75,11 +128,16 @@ public:
     /// Clear column data.
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of current column, with compacted dictionary
     ColumnRef Slice(size_t begin, size_t len) const override;
+    /// Result shares none of the data with the current column, but keeps the whole dictionary.
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
     ItemView GetItem(size_t index) const override;
@@ -87,6 +145,12 @@ public:
     size_t GetDictionarySize() const;
     TypeRef GetNestedType() const;
 
+    /// Returns dictionary, which starts with the null item (if nested type is Nullable) and the default item.
+    inline ColumnRef Dictionary() const { return dictionary_column_; }
+
+    /// Returns UInt8/16/32/64 column of indices in the dictionary of all rows.
+    inline ColumnRef Indices() const { return index_column_; }
+
 protected:
     std::uint64_t getDictionaryIndex(std::uint64_t item_index) const;
     void appendIndex(std::uint64_t item_index);
@@ -99,9 +163,15 @@ private:
     void Setup(ColumnRef dictionary_column);
     void AppendNullItem();
     void AppendDefaultItem();
+    /// Finds the item in the dictionary, adding it if there is none. Returns its index in the dictionary.
+    std::uint64_t FindOrAddToDictionary(const ItemView &);
+    void BuildUniqueItemsMap();
+    template <typename ValuesColumnType>
+    void AppendFromImpl(const Column& column);
 
 public:
-    static details::LowCardinalityHashKey computeHashKey(const ItemView &);
+    /// Hash of the item, same for FixedString values, which differ only by trailing zeroes.
+    static std::uint64_t computeHashKey(const ItemView &);
 };
 
 /** Type-aware wrapper that provides simple convenience interface for accessing/appending individual items.
@@ -150,9 +220,12 @@ public:
 
     template <typename T>
     inline void AppendMany(const T& container) {
+        // Values are collected into a plain column first, which is appended in batches.
+        auto values = typed_dictionary_.CloneEmpty()->template As<DictionaryColumnType>();
         for (const auto & item : container) {
-            Append(item);
+            values->Append(item);
         }
+        AppendFrom(*values);
     }
 };
 
@@ -37,6 +37,10 @@ void ColumnMap::Clear() {
     data_->Clear();
 }
 
+void ColumnMap::Reserve(size_t new_cap) {
+    data_->Reserve(new_cap);
+}
+
 void ColumnMap::Append(ColumnRef column) {
     if (auto col = column->As<ColumnMap>()) {
         data_->Append(col->data_);
@@ -67,6 +71,10 @@ ColumnRef ColumnMap::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnMap>(data_->Slice(begin, len));
 }
 
+ColumnRef ColumnMap::Permute(const std::vector<size_t>& indices) const {
+    return std::make_shared<ColumnMap>(data_->Permute(indices));
+}
+
 ColumnRef ColumnMap::CloneEmpty() const {
     return std::make_shared<ColumnMap>(data_->CloneEmpty());
 }
@@ -43,11 +43,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t, size_t) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column&) override;
 
@@ -87,6 +91,10 @@ public:
         return std::make_shared<ColumnMapT<K, V>>(typed_data_->Slice(begin, len));
     }
 
+    ColumnRef Permute(const std::vector<size_t>& indices) const override {
+        return std::make_shared<ColumnMapT<K, V>>(typed_data_->Permute(indices));
+    }
+
     ColumnRef CloneEmpty() const override {
         return std::make_shared<ColumnMapT<K, V>>(typed_data_->CloneEmpty());
     }
@@ -50,6 +50,11 @@ void ColumnNullable::Clear() {
     nulls_->Clear();
 }
 
+void ColumnNullable::Reserve(size_t new_cap) {
+    nested_->Reserve(new_cap);
+    nulls_->Reserve(new_cap);
+}
+
 bool ColumnNullable::LoadPrefix(InputStream* input, size_t rows) {
     return nested_->LoadPrefix(input, rows);
 }
@@ -81,6 +86,10 @@ ColumnRef ColumnNullable::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnNullable>(nested_->Slice(begin, len), nulls_->Slice(begin, len));
 }
 
+ColumnRef ColumnNullable::Permute(const std::vector<size_t>& indices) const {
+    return std::make_shared<ColumnNullable>(nested_->Permute(indices), nulls_->Permute(indices));
+}
+
 ColumnRef ColumnNullable::CloneEmpty() const {
     return std::make_shared<ColumnNullable>(nested_->CloneEmpty(), nulls_->CloneEmpty());
 }
@@ -43,6 +43,11 @@ void ColumnVector<T>::Clear() {
     data_.clear();
 }
 
+template <typename T>
+void ColumnVector<T>::Reserve(size_t new_cap) {
+    data_.reserve(new_cap);
+}
+
 template <typename T>
 const T& ColumnVector<T>::At(size_t n) const {
     return data_.at(n);
@@ -82,6 +87,60 @@ ColumnRef ColumnVector<T>::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnVector<T>>(SliceVector(data_, begin, len));
 }
 
+template <typename T>
+ColumnRef ColumnVector<T>::Filter(const std::vector<uint8_t>& mask) const {
+    CheckFilterMask(mask);
+
+    // Every value is copied and the position moves only past the selected ones, so the loop has no branches.
+    std::vector<T> result(data_.size());
+    size_t pos = 0;
+    for (size_t i = 0; i < data_.size(); ++i) {
+        result[pos] = data_[i];
+        pos += mask[i] != 0;
+    }
+    result.resize(pos);
+
+    return std::make_shared<ColumnVector<T>>(std::move(result));
+}
+
+template <typename T>
+ColumnRef ColumnVector<T>::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    std::vector<T> result(indices.size());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        result[i] = data_[indices[i]];
+    }
+
+    return std::make_shared<ColumnVector<T>>(std::move(result));
+}
+
+template <typename T>
+std::vector<ColumnRef> ColumnVector<T>::Scatter(const std::vector<size_t>& selector, size_t num_columns) const {
+    CheckSelector(selector, num_columns);
+
+    std::vector<size_t> sizes(num_columns);
+    for (auto column : selector) {
+        ++sizes[column];
+    }
+
+    std::vector<std::vector<T>> parts(num_columns);
+    for (size_t i = 0; i < num_columns; ++i) {
+        parts[i].reserve(sizes[i]);
+    }
+    for (size_t i = 0; i < data_.size(); ++i) {
+        parts[selector[i]].push_back(data_[i]);
+    }
+
+    std::vector<ColumnRef> result;
+    result.reserve(num_columns);
+    for (auto& part : parts) {
+        result.push_back(std::make_shared<ColumnVector<T>>(std::move(part)));
+    }
+
+    return result;
+}
+
 template <typename T>
 ColumnRef ColumnVector<T>::CloneEmpty() const {
     return std::make_shared<ColumnVector<T>>();
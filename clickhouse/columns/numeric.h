@@ -22,6 +22,12 @@ public:
     /// Appends one element to the end of column.
     void Append(const T& value);
 
+    /// Appends elements of the range to the end of column.
+    template <typename Iterator>
+    inline void AppendMany(Iterator begin, Iterator end) {
+        data_.insert(data_.end(), begin, end);
+    }
+
     /// Returns element at given row number.
     const T& At(size_t n) const;
 
@@ -30,6 +36,11 @@ public:
 
     void Erase(size_t pos, size_t count = 1);
 
+    /// Returns all elements of the column.
+    inline const std::vector<T>& GetData() const {
+        return data_;
+    }
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -43,11 +54,17 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Filter(const std::vector<uint8_t>& mask) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
+    std::vector<ColumnRef> Scatter(const std::vector<size_t>& selector, size_t num_columns) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -0,0 +1,257 @@
+#include "sparse.h"
+
+#include "../base/input.h"
+#include "../base/wire_format.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace clickhouse {
+
+namespace {
+
+/// Marks the number of default values at the end of the column.
+constexpr uint64_t END_OF_GRANULE_FLAG = 1ULL << 62;
+
+/// Default values of all types, that support sparse serialization,
+/// are encoded with zero bytes, so columns of them are loaded from an endless stream of zeros.
+class ZeroInput : public InputStream {
+public:
+    bool Skip(size_t) override {
+        return true;
+    }
+
+protected:
+    size_t DoRead(void* buf, size_t len) override {
+        std::memset(buf, 0, len);
+        return len;
+    }
+};
+
+}
+
+ColumnSparse::ColumnSparse(ColumnRef values)
+    : ColumnSparse(values, {}, 0)
+{
+}
+
+ColumnSparse::ColumnSparse(ColumnRef values, std::vector<uint64_t> offsets, size_t size)
+    : Column(values ? values->Type() : nullptr)
+    , values_(values)
+    , offsets_(std::move(offsets))
+    , size_(size)
+{
+    if (!values_) {
+        throw ValidationError("ColumnSparse requires a column of values");
+    }
+    if (values_->As<ColumnSparse>()) {
+        throw ValidationError("ColumnSparse can't be nested");
+    }
+    if (values_->Size() != offsets_.size()) {
+        throw ValidationError("ColumnSparse: number of values and offsets must match");
+    }
+    if (!std::is_sorted(offsets_.begin(), offsets_.end()) ||
+        std::adjacent_find(offsets_.begin(), offsets_.end()) != offsets_.end() ||
+        (!offsets_.empty() && offsets_.back() >= size_)) {
+        throw ValidationError("ColumnSparse: offsets must be unique, sorted and less than the column size");
+    }
+}
+
+void ColumnSparse::AppendDefaults(size_t count) {
+    size_ += count;
+    dense_.reset();
+}
+
+ColumnRef ColumnSparse::Dense() const {
+    if (dense_) {
+        return dense_;
+    }
+
+    ColumnRef defaults = MakeDefaults(size_ - offsets_.size());
+    if (offsets_.empty()) {
+        return dense_ = defaults;
+    }
+
+    auto dense = values_->CloneEmpty();
+    dense->Reserve(size_);
+
+    size_t row = 0;
+    size_t default_pos = 0;
+    for (size_t i = 0; i < offsets_.size(); ) {
+        if (const size_t gap = offsets_[i] - row) {
+            dense->Append(defaults->Slice(default_pos, gap));
+            default_pos += gap;
+            row += gap;
+        }
+
+        // Consecutive values are appended at once.
+        size_t j = i + 1;
+        while (j < offsets_.size() && offsets_[j] == offsets_[j - 1] + 1) {
+            ++j;
+        }
+        dense->Append(values_->Slice(i, j - i));
+        row += j - i;
+        i = j;
+    }
+    if (row < size_) {
+        dense->Append(defaults->Slice(default_pos, size_ - row));
+    }
+
+    return dense_ = dense;
+}
+
+void ColumnSparse::Append(ColumnRef column) {
+    if (!column->Type()->IsEqual(type_)) {
+        throw ValidationError("Can't append column of type " + column->Type()->GetName() + " to ColumnSparse of type " + type_->GetName());
+    }
+
+    if (auto col = column->As<ColumnSparse>()) {
+        offsets_.reserve(offsets_.size() + col->offsets_.size());
+        for (auto offset : col->offsets_) {
+            offsets_.push_back(size_ + offset);
+        }
+        values_->Append(col->values_);
+        size_ += col->size_;
+    } else {
+        const size_t rows = column->Size();
+        offsets_.reserve(offsets_.size() + rows);
+        for (size_t i = 0; i < rows; ++i) {
+            offsets_.push_back(size_ + i);
+        }
+        values_->Append(column);
+        size_ += rows;
+    }
+
+    dense_.reset();
+}
+
+bool ColumnSparse::LoadPrefix(InputStream* input, size_t rows) {
+    return values_->LoadPrefix(input, rows);
+}
+
+bool ColumnSparse::LoadBody(InputStream* input, size_t rows) {
+    const size_t num_offsets = offsets_.size();
+    size_t row = 0;
+
+    while (true) {
+        uint64_t group_size;
+        if (!WireFormat::ReadVarint64(*input, &group_size)) {
+            return false;
+        }
+
+        if (group_size & END_OF_GRANULE_FLAG) {
+            row += group_size & ~END_OF_GRANULE_FLAG;
+            break;
+        }
+
+        // `group_size` default values followed by a non-default one.
+        row += group_size;
+        if (row >= rows) {
+            return false;
+        }
+        offsets_.push_back(size_ + row);
+        ++row;
+    }
+
+    if (row != rows) {
+        return false;
+    }
+
+    const size_t num_values = offsets_.size() - num_offsets;
+    if (num_values && !values_->LoadBody(input, num_values)) {
+        return false;
+    }
+
+    size_ += rows;
+    dense_.reset();
+
+    return true;
+}
+
+void ColumnSparse::SavePrefix(OutputStream* output) {
+    values_->SavePrefix(output);
+}
+
+void ColumnSparse::SaveBody(OutputStream* output) {
+    uint64_t start = 0;
+    for (auto offset : offsets_) {
+        WireFormat::WriteVarint64(*output, offset - start);
+        start = offset + 1;
+    }
+    WireFormat::WriteVarint64(*output, (size_ - start) | END_OF_GRANULE_FLAG);
+
+    if (!offsets_.empty()) {
+        values_->SaveBody(output);
+    }
+}
+
+void ColumnSparse::Clear() {
+    values_->Clear();
+    offsets_.clear();
+    size_ = 0;
+    dense_.reset();
+}
+
+size_t ColumnSparse::Size() const {
+    return size_;
+}
+
+ColumnRef ColumnSparse::Slice(size_t begin, size_t len) const {
+    begin = std::min(begin, size_);
+    len = std::min(len, size_ - begin);
+
+    const auto first = std::lower_bound(offsets_.begin(), offsets_.end(), begin);
+    const auto last = std::lower_bound(first, offsets_.end(), begin + len);
+
+    std::vector<uint64_t> offsets;
+    offsets.reserve(last - first);
+    for (auto it = first; it != last; ++it) {
+        offsets.push_back(*it - begin);
+    }
+
+    auto values = values_->Slice(first - offsets_.begin(), last - first);
+    return std::make_shared<ColumnSparse>(values, std::move(offsets), len);
+}
+
+ColumnRef ColumnSparse::CloneEmpty() const {
+    return std::make_shared<ColumnSparse>(values_->CloneEmpty());
+}
+
+void ColumnSparse::Swap(Column& other) {
+    auto & col = dynamic_cast<ColumnSparse &>(other);
+    type_.swap(col.type_);
+    values_.swap(col.values_);
+    offsets_.swap(col.offsets_);
+    std::swap(size_, col.size_);
+    dense_.swap(col.dense_);
+    default_value_.swap(col.default_value_);
+}
+
+ItemView ColumnSparse::GetItem(size_t index) const {
+    if (index >= size_) {
+        throw ValidationError("Index is out ouf bounds: " + std::to_string(index));
+    }
+
+    const auto it = std::lower_bound(offsets_.begin(), offsets_.end(), index);
+    if (it != offsets_.end() && *it == index) {
+        return values_->GetItem(it - offsets_.begin());
+    }
+
+    if (!default_value_) {
+        default_value_ = MakeDefaults(1);
+    }
+    return default_value_->GetItem(0);
+}
+
+ColumnRef ColumnSparse::MakeDefaults(size_t rows) const {
+    auto defaults = values_->CloneEmpty();
+
+    ZeroInput zeros;
+    if (rows && !defaults->LoadBody(&zeros, rows)) {
+        throw ValidationError("Can't create default values of type " + type_->GetName());
+    }
+
+    return defaults;
+}
+
+}
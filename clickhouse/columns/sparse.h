@@ -0,0 +1,85 @@
+#pragma once
+
+#include "column.h"
+
+#include <vector>
+
+namespace clickhouse {
+
+/**
+ * Represents column in sparse serialization: only non-default values are stored,
+ * along with their row numbers. All other rows hold the default value of the type
+ * (zero, empty string, etc).
+ *
+ * Server sends columns, that consist mostly of default values, in this form,
+ * see ClientOptions::keep_sparse_columns.
+ */
+class ColumnSparse : public Column {
+public:
+    /// Creates an empty column, `values` is an empty column of the nested type.
+    explicit ColumnSparse(ColumnRef values);
+
+    /** Takes ownership of the data.
+     * @param values non-default values.
+     * @param offsets sorted row numbers of `values`, there must be as many of them as values.
+     * @param size total number of rows.
+     */
+    ColumnSparse(ColumnRef values, std::vector<uint64_t> offsets, size_t size);
+
+    /// Appends `count` rows with the default value.
+    void AppendDefaults(size_t count);
+
+    /// Returns column with non-default values.
+    inline ColumnRef Values() const { return values_; }
+
+    /// Returns sorted row numbers of non-default values.
+    inline const std::vector<uint64_t>& Offsets() const { return offsets_; }
+
+    /// Returns an ordinary column with the same content.
+    /// It is built on the first call and kept until the column is modified.
+    ColumnRef Dense() const;
+
+public:
+    /// Appends content of given column to the end of current one.
+    /// Rows of a non-sparse column are all appended as non-default values.
+    void Append(ColumnRef column) override;
+
+    /// Loads column prefix from input stream.
+    bool LoadPrefix(InputStream* input, size_t rows) override;
+
+    /// Loads column data from input stream.
+    bool LoadBody(InputStream* input, size_t rows) override;
+
+    /// Saves column prefix to output stream.
+    void SavePrefix(OutputStream* output) override;
+
+    /// Saves column data to output stream.
+    void SaveBody(OutputStream* output) override;
+
+    /// Clear column data .
+    void Clear() override;
+
+    /// Returns count of rows in the column.
+    size_t Size() const override;
+
+    /// Makes slice of the current column.
+    ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef CloneEmpty() const override;
+    void Swap(Column& other) override;
+
+    ItemView GetItem(size_t index) const override;
+
+private:
+    /// Column of `rows` default values.
+    ColumnRef MakeDefaults(size_t rows) const;
+
+private:
+    ColumnRef values_;
+    std::vector<uint64_t> offsets_;
+    size_t size_;
+
+    mutable ColumnRef dense_;
+    mutable ColumnRef default_value_;
+};
+
+}
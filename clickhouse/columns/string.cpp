@@ -1,12 +1,125 @@
 #include "string.h"
 #include "utils.h"
 
+#include "../base/input.h"
+#include "../base/output.h"
 #include "../base/wire_format.h"
 
+#include <stdexcept>
+
 namespace {
 
 constexpr size_t DEFAULT_BLOCK_SIZE = 4096;
 
+constexpr size_t MAX_VARINT_BYTES = 10;
+/// Size of chunks of values, written to streams which are not ZeroCopyOutput.
+constexpr size_t STAGING_CHUNK_SIZE = 64 * 1024;
+
+/// Count of bytes of the value encoded as varint.
+inline size_t VarintSize(uint64_t value) {
+    size_t size = 1;
+    for (; value >= 0x80; value >>= 7) {
+        ++size;
+    }
+    return size;
+}
+
+inline size_t EncodeVarint(uint64_t value, uint8_t* buf) {
+    size_t size = 0;
+    for (; value >= 0x80; value >>= 7) {
+        buf[size++] = static_cast<uint8_t>(value | 0x80);
+    }
+    buf[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+/**
+ * Writes exactly `total_size` bytes into windows obtained with ZeroCopyOutput::Next(),
+ * or into a staging chunk for other streams, instead of a write per value.
+ * Values may be split between windows.
+ */
+class ChunkWriter {
+public:
+    ChunkWriter(clickhouse::OutputStream& output, size_t total_size)
+        : output_(output)
+        , zero_copy_(dynamic_cast<clickhouse::ZeroCopyOutput*>(&output))
+        , remaining_(total_size)
+    {
+    }
+
+    inline void WriteVarint(uint64_t value) {
+        if (static_cast<size_t>(end_ - pos_) >= MAX_VARINT_BYTES) {
+            pos_ += EncodeVarint(value, pos_);
+        } else {
+            uint8_t buf[MAX_VARINT_BYTES];
+            Write(buf, EncodeVarint(value, buf));
+        }
+    }
+
+    inline void Write(const void* data, size_t len) {
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        while (len > static_cast<size_t>(end_ - pos_)) {
+            const size_t part = end_ - pos_;
+            if (part) {
+                memcpy(pos_, src, part);
+                src += part;
+                len -= part;
+                pos_ = end_;
+            }
+            NextWindow();
+        }
+        if (len) {
+            memcpy(pos_, src, len);
+            pos_ += len;
+        }
+    }
+
+    void Finish() {
+        FlushStaging();
+    }
+
+private:
+    void NextWindow() {
+        if (remaining_ == 0) {
+            throw clickhouse::ProtocolError("attempt to write more data than was expected");
+        }
+
+        size_t size = 0;
+        if (zero_copy_) {
+            void* window = nullptr;
+            size = zero_copy_->Next(&window, remaining_);
+            if (size == 0) {
+                throw clickhouse::ProtocolError("failed to obtain buffer of output stream");
+            }
+            pos_ = static_cast<uint8_t*>(window);
+        } else {
+            FlushStaging();
+            size = std::min(remaining_, STAGING_CHUNK_SIZE);
+            staging_.resize(size);
+            pos_ = staging_.data();
+        }
+
+        end_ = pos_ + size;
+        remaining_ -= size;
+    }
+
+    void FlushStaging() {
+        if (!zero_copy_ && !staging_.empty()) {
+            clickhouse::WireFormat::WriteBytes(output_, staging_.data(), pos_ - staging_.data());
+            staging_.clear();
+        }
+    }
+
+private:
+    clickhouse::OutputStream& output_;
+    clickhouse::ZeroCopyOutput* const zero_copy_;
+    /// Bytes, which are not in windows yet.
+    size_t remaining_;
+    uint8_t* pos_ = nullptr;
+    uint8_t* end_ = nullptr;
+    std::vector<uint8_t> staging_;
+};
+
 template <typename Container>
 size_t ComputeTotalSize(const Container & strings, size_t begin = 0, size_t len = -1) {
     size_t result = 0;
@@ -53,6 +166,10 @@ void ColumnFixedString::Clear() {
     data_.clear();
 }
 
+void ColumnFixedString::Reserve(size_t new_cap) {
+    data_.reserve(string_size_ * new_cap);
+}
+
 std::string_view ColumnFixedString::At(size_t n) const {
     const auto pos = n * string_size_;
     return std::string_view(&data_.at(pos), string_size_);
@@ -104,6 +221,18 @@ ColumnRef ColumnFixedString::Slice(size_t begin, size_t len) const {
     return result;
 }
 
+ColumnRef ColumnFixedString::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    auto result = std::make_shared<ColumnFixedString>(string_size_);
+    result->data_.resize(indices.size() * string_size_);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        memcpy(&result->data_[i * string_size_], &data_[indices[i] * string_size_], string_size_);
+    }
+
+    return result;
+}
+
 ColumnRef ColumnFixedString::CloneEmpty() const {
     return std::make_shared<ColumnFixedString>(string_size_);
 }
@@ -118,62 +247,25 @@ ItemView ColumnFixedString::GetItem(size_t index) const {
     return ItemView{Type::FixedString, this->At(index)};
 }
 
-struct ColumnString::Block
-{
-    using CharT = typename std::string::value_type;
-
-    explicit Block(size_t starting_capacity)
-        : size(0),
-        capacity(starting_capacity),
-        data_(new CharT[capacity])
-    {}
-
-    inline auto GetAvailable() const {
-        return capacity - size;
-    }
-
-    std::string_view AppendUnsafe(std::string_view str) {
-        const auto pos = &data_[size];
-
-        memcpy(pos, str.data(), str.size());
-        size += str.size();
-
-        return std::string_view(pos, str.size());
-    }
-
-    auto GetCurrentWritePos() {
-        return &data_[size];
-    }
-
-    std::string_view ConsumeTailAsStringViewUnsafe(size_t len) {
-        const auto start = &data_[size];
-        size += len;
-        return std::string_view(start, len);
-    }
-
-    size_t size;
-    const size_t capacity;
-    std::unique_ptr<CharT[]> data_;
-};
-
 ColumnString::ColumnString()
     : Column(Type::CreateString())
+    , offsets_(1, 0)
 {
 }
 
 ColumnString::ColumnString(size_t element_count)
-    : Column(Type::CreateString())
+    : ColumnString()
 {
-    items_.reserve(element_count);
-    // 100 is arbitrary number, assumption that string values are about ~40 bytes long.
-    blocks_.reserve(std::max<size_t>(1, element_count / 100));
+    offsets_.reserve(element_count + 1);
+    // 40 is arbitrary number, assumption that string values are about ~40 bytes long.
+    chars_.reserve(element_count * 40);
 }
 
 ColumnString::ColumnString(const std::vector<std::string>& data)
     : ColumnString()
 {
-    items_.reserve(data.size());
-    blocks_.emplace_back(ComputeTotalSize(data));
+    offsets_.reserve(data.size() + 1);
+    chars_.reserve(ComputeTotalSize(data));
 
     for (const auto & s : data) {
         AppendUnsafe(s);
@@ -181,14 +273,26 @@ ColumnString::ColumnString(const std::vector<std::string>& data)
 };
 
 ColumnString::ColumnString(std::vector<std::string>&& data)
-    : ColumnString()
+    : ColumnString(static_cast<const std::vector<std::string>&>(data))
 {
-    items_.reserve(data.size());
+}
 
-    for (auto&& d : data) {
-        append_data_.emplace_back(std::move(d));
-        auto& last_data = append_data_.back();
-        items_.emplace_back(std::string_view{ last_data.data(),last_data.length() });
+ColumnString::ColumnString(std::vector<char>&& chars, std::vector<uint64_t>&& offsets)
+    : Column(Type::CreateString())
+    , chars_(std::move(chars))
+    , offsets_(std::move(offsets))
+{
+    if (offsets_.empty() || offsets_.front() != 0) {
+        throw ValidationError("offsets of ColumnString must start with zero");
+    }
+    for (size_t i = 1; i < offsets_.size(); ++i) {
+        if (offsets_[i] < offsets_[i - 1]) {
+            throw ValidationError("offsets of ColumnString must not decrease");
+        }
+    }
+    if (offsets_.back() != chars_.size()) {
+        throw ValidationError("last offset of ColumnString " + std::to_string(offsets_.back())
+                + " does not match size of chars " + std::to_string(chars_.size()));
     }
 }
 
@@ -196,11 +300,7 @@ ColumnString::~ColumnString()
 {}
 
 void ColumnString::Append(std::string_view str) {
-    if (blocks_.size() == 0 || blocks_.back().GetAvailable() < str.length()) {
-        blocks_.emplace_back(std::max(DEFAULT_BLOCK_SIZE, str.size()));
-    }
-
-    items_.emplace_back(blocks_.back().AppendUnsafe(str));
+    AppendUnsafe(str);
 }
 
 void ColumnString::Append(const char* str) {
@@ -208,98 +308,195 @@ void ColumnString::Append(const char* str) {
 }
 
 void ColumnString::Append(std::string&& steal_value) {
-    append_data_.emplace_back(std::move(steal_value));
-    auto& last_data = append_data_.back();
-    items_.emplace_back(std::string_view{ last_data.data(),last_data.length() });
+    AppendUnsafe(steal_value);
 }
 
 void ColumnString::AppendNoManagedLifetime(std::string_view str) {
-    items_.emplace_back(str);
+    AppendUnsafe(str);
 }
 
 void ColumnString::AppendUnsafe(std::string_view str) {
-    items_.emplace_back(blocks_.back().AppendUnsafe(str));
+    chars_.insert(chars_.end(), str.begin(), str.end());
+    offsets_.push_back(chars_.size());
 }
 
 void ColumnString::Clear() {
-    items_.clear();
-    blocks_.clear();
-    append_data_.clear();
-    append_data_.shrink_to_fit();
+    chars_.clear();
+    offsets_.assign(1, 0);
+}
+
+void ColumnString::Reserve(size_t new_cap) {
+    offsets_.reserve(new_cap + 1);
 }
 
 std::string_view ColumnString::At(size_t n) const {
-    return items_.at(n);
+    if (n >= Size()) {
+        throw std::out_of_range("index " + std::to_string(n) + " is out of range of ColumnString of size " + std::to_string(Size()));
+    }
+    return (*this)[n];
 }
 
 std::string_view ColumnString::operator [] (size_t n) const {
-    return items_[n];
+    return std::string_view(chars_.data() + offsets_[n], offsets_[n + 1] - offsets_[n]);
 }
 
 void ColumnString::Append(ColumnRef column) {
     if (auto col = column->As<ColumnString>()) {
-        const auto total_size = ComputeTotalSize(col->items_);
+        const size_t rows = col->Size();
+        const size_t base = chars_.size();
 
-        // TODO: fill up existing block with some items and then add a new one for the rest of items
-        if (blocks_.size() == 0 || blocks_.back().GetAvailable() < total_size)
-            blocks_.emplace_back(std::max(DEFAULT_BLOCK_SIZE, total_size));
+        // Column may be appended to itself, so sizes are taken before growing.
+        offsets_.reserve(offsets_.size() + rows);
 
-        // Intentionally not doing items_.reserve() since that cripples performance.
-        for (size_t i = 0; i < column->Size(); ++i) {
-            this->AppendUnsafe((*col)[i]);
+        const size_t size = col->chars_.size();
+        chars_.resize(base + size);
+        if (size) {
+            memcpy(chars_.data() + base, col->chars_.data(), size);
+        }
+        for (size_t i = 1; i <= rows; ++i) {
+            offsets_.push_back(base + col->offsets_[i]);
         }
     }
 }
 
 bool ColumnString::LoadBody(InputStream* input, size_t rows) {
-    items_.clear();
-    blocks_.clear();
-
-    items_.reserve(rows);
-    Block * block = nullptr;
+    Clear();
+    offsets_.reserve(rows + 1);
+
+    auto zero_copy = dynamic_cast<ZeroCopyInput*>(input);
+
+    while (Size() < rows) {
+        if (zero_copy) {
+            const void* window = nullptr;
+            const size_t window_size = zero_copy->Peek(&window);
+            const size_t consumed = LoadFromWindow(static_cast<const uint8_t*>(window), window_size, rows - Size());
+            if (consumed) {
+                zero_copy->Skip(consumed);
+                continue;
+            }
+        }
 
-    // TODO(performance): unroll a loop to a first row (to get rid of `blocks_.size() == 0` check) and the rest.
-    for (size_t i = 0; i < rows; ++i) {
+        // Value crosses the boundary of the window, or the input can't look ahead.
         uint64_t len;
         if (!WireFormat::ReadUInt64(*input, &len))
             return false;
 
-        if (blocks_.size() == 0 || len > block->GetAvailable())
-            block = &blocks_.emplace_back(std::max<size_t>(DEFAULT_BLOCK_SIZE, len));
-
-        if (!WireFormat::ReadBytes(*input, block->GetCurrentWritePos(), len))
+        const size_t pos = chars_.size();
+        chars_.resize(pos + len);
+        if (!WireFormat::ReadBytes(*input, chars_.data() + pos, len))
             return false;
 
-        items_.emplace_back(block->ConsumeTailAsStringViewUnsafe(len));
+        offsets_.push_back(chars_.size());
     }
 
     return true;
 }
 
+size_t ColumnString::LoadFromWindow(const uint8_t* data, size_t size, size_t max_rows) {
+    const size_t first_row = offsets_.size();
+    size_t pos = 0;
+
+    // Lengths are decoded first, so chars are resized once for all values of the window.
+    for (; max_rows > 0 && pos < size; --max_rows) {
+        uint64_t len = data[pos];
+        size_t len_size = 1;
+
+        if (len & 0x80) {
+            // Rare lengths of more than 127 bytes.
+            len &= 0x7F;
+            bool complete = false;
+            for (size_t shift = 7; len_size < 10 && pos + len_size < size; shift += 7) {
+                const uint8_t byte = data[pos + len_size++];
+                len |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete) {
+                break;
+            }
+        }
+
+        if (size - pos - len_size < len) {
+            break;
+        }
+
+        offsets_.push_back(offsets_.back() + len);
+        pos += len_size + len;
+    }
+
+    if (pos == 0) {
+        return 0;
+    }
+
+    size_t src = 0;
+    chars_.resize(offsets_.back());
+    for (size_t i = first_row; i < offsets_.size(); ++i) {
+        while (data[src++] & 0x80) {
+        }
+        const size_t len = offsets_[i] - offsets_[i - 1];
+        memcpy(chars_.data() + offsets_[i - 1], data + src, len);
+        src += len;
+    }
+
+    return pos;
+}
+
 void ColumnString::SaveBody(OutputStream* output) {
-    for (const auto & item : items_) {
-        WireFormat::WriteString(*output, item);
+    const size_t rows = Size();
+
+    size_t total_size = chars_.size();
+    for (size_t i = 0; i < rows; ++i) {
+        total_size += VarintSize(offsets_[i + 1] - offsets_[i]);
     }
+
+    ChunkWriter writer(*output, total_size);
+    for (size_t i = 0; i < rows; ++i) {
+        const size_t len = offsets_[i + 1] - offsets_[i];
+        writer.WriteVarint(len);
+        writer.Write(chars_.data() + offsets_[i], len);
+    }
+    writer.Finish();
 }
 
 size_t ColumnString::Size() const {
-    return items_.size();
+    return offsets_.size() - 1;
 }
 
 ColumnRef ColumnString::Slice(size_t begin, size_t len) const {
-    auto result = std::make_shared<ColumnString>();
+    std::vector<char> chars;
+    std::vector<uint64_t> offsets(1, 0);
 
-    if (begin < items_.size()) {
-        len = std::min(len, items_.size() - begin);
-        result->items_.reserve(len);
+    if (begin < Size()) {
+        len = std::min(len, Size() - begin);
 
-        result->blocks_.emplace_back(ComputeTotalSize(items_, begin, len));
-        for (size_t i = begin; i < begin + len; ++i) {
-            result->Append(items_[i]);
+        const auto first = offsets_[begin];
+        chars.assign(chars_.begin() + first, chars_.begin() + offsets_[begin + len]);
+        offsets.resize(len + 1);
+        for (size_t i = 1; i <= len; ++i) {
+            offsets[i] = offsets_[begin + i] - first;
         }
     }
 
-    return result;
+    return std::make_shared<ColumnString>(std::move(chars), std::move(offsets));
+}
+
+ColumnRef ColumnString::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    std::vector<uint64_t> offsets(indices.size() + 1);
+    offsets[0] = 0;
+    for (size_t i = 0; i < indices.size(); ++i) {
+        offsets[i + 1] = offsets[i] + (offsets_[indices[i] + 1] - offsets_[indices[i]]);
+    }
+
+    std::vector<char> chars(offsets.back());
+    for (size_t i = 0; i < indices.size(); ++i) {
+        memcpy(chars.data() + offsets[i], chars_.data() + offsets_[indices[i]], offsets[i + 1] - offsets[i]);
+    }
+
+    return std::make_shared<ColumnString>(std::move(chars), std::move(offsets));
 }
 
 ColumnRef ColumnString::CloneEmpty() const {
@@ -308,9 +505,8 @@ ColumnRef ColumnString::CloneEmpty() const {
 
 void ColumnString::Swap(Column& other) {
     auto & col = dynamic_cast<ColumnString &>(other);
-    items_.swap(col.items_);
-    blocks_.swap(col.blocks_);
-    append_data_.swap(col.append_data_);
+    chars_.swap(col.chars_);
+    offsets_.swap(col.offsets_);
 }
 
 ItemView ColumnString::GetItem(size_t index) const {
@@ -6,7 +6,6 @@
 #include <string_view>
 #include <utility>
 #include <vector>
-#include <deque>
 
 namespace clickhouse {
 
@@ -52,11 +51,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
 
@@ -69,6 +72,9 @@ private:
 
 /**
  * Represents column of variable-length strings.
+ *
+ * Values are stored one after another in a single buffer of chars,
+ * with offsets of values in it, as ClickHouse does.
  */
 class ColumnString : public Column {
 public:
@@ -81,6 +87,8 @@ public:
     explicit ColumnString(size_t element_count);
     explicit ColumnString(const std::vector<std::string> & data);
     explicit ColumnString(std::vector<std::string>&& data);
+    /// Creates column from chars and offsets of values, see GetChars() and GetOffsets().
+    ColumnString(std::vector<char>&& chars, std::vector<uint64_t>&& offsets);
     ColumnString& operator=(const ColumnString&) = delete;
     ColumnString(const ColumnString&) = delete;
 
@@ -94,15 +102,27 @@ public:
     void Append(std::string&& steal_value);
 
     /// Appends one element to the column.
-    /// If str lifetime is managed elsewhere and guaranteed to outlive the Block sent to the server
+    /// Kept for compatibility: the value is copied, as by Append().
     void AppendNoManagedLifetime(std::string_view str);
 
     /// Returns element at given row number.
+    /// The value is valid until the column is modified.
     std::string_view At(size_t n) const;
 
     /// Returns element at given row number.
     std::string_view operator [] (size_t n) const;
 
+    /// Returns chars of all values, one after another.
+    inline const std::vector<char>& GetChars() const {
+        return chars_;
+    }
+
+    /// Returns Size() + 1 offsets of values in chars, starting with zero:
+    /// value n occupies [offsets[n], offsets[n + 1]).
+    inline const std::vector<uint64_t>& GetOffsets() const {
+        return offsets_;
+    }
+
 public:
     /// Appends content of given column to the end of current one.
     void Append(ColumnRef column) override;
@@ -116,11 +136,15 @@ public:
     /// Clear column data .
     void Clear() override;
 
+    /// Increase the capacity of the column for large block insertion.
+    void Reserve(size_t new_cap) override;
+
     /// Returns count of rows in the column.
     size_t Size() const override;
 
     /// Makes slice of the current column.
     ColumnRef Slice(size_t begin, size_t len) const override;
+    ColumnRef Permute(const std::vector<size_t>& indices) const override;
     ColumnRef CloneEmpty() const override;
     void Swap(Column& other) override;
     ItemView GetItem(size_t) const override;
@@ -128,12 +152,13 @@ public:
 private:
     void AppendUnsafe(std::string_view);
 
-private:
-    struct Block;
+    /// Appends up to `max_rows` values, which are entirely in the window of input.
+    /// Returns count of bytes of the window taken by the values.
+    size_t LoadFromWindow(const uint8_t* data, size_t size, size_t max_rows);
 
-    std::vector<std::string_view> items_;
-    std::vector<Block> blocks_;
-    std::deque<std::string> append_data_;
+private:
+    std::vector<char> chars_;
+    std::vector<uint64_t> offsets_;
 };
 
 }
@@ -45,6 +45,16 @@ ColumnRef ColumnTuple::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnTuple>(sliced_columns);
 }
 
+ColumnRef ColumnTuple::Permute(const std::vector<size_t>& indices) const {
+    std::vector<ColumnRef> permuted_columns;
+    permuted_columns.reserve(columns_.size());
+    for(const auto &column : columns_) {
+        permuted_columns.push_back(column->Permute(indices));
+    }
+
+    return std::make_shared<ColumnTuple>(permuted_columns);
+}
+
 ColumnRef ColumnTuple::CloneEmpty() const {
     std::vector<ColumnRef> result_columns;
     result_columns.reserve(columns_.size());
@@ -92,6 +102,12 @@ void ColumnTuple::Clear() {
     columns_.clear();
 }
 
+void ColumnTuple::Reserve(size_t new_cap) {
+    for (auto & column : columns_) {
+        column->Reserve(new_cap);
+    }
+}
+
 void ColumnTuple::Swap(Column& other) {
     auto & col = dynamic_cast<ColumnTuple &>(other);
     columns_.swap(col.columns_);
@@ -30,6 +30,10 @@ void ColumnUUID::Clear() {
     data_->Clear();
 }
 
+void ColumnUUID::Reserve(size_t new_cap) {
+    data_->Reserve(2 * new_cap);
+}
+
 const UUID ColumnUUID::At(size_t n) const {
     return UUID(data_->At(n * 2), data_->At(n * 2 + 1));
 }
@@ -60,6 +64,20 @@ ColumnRef ColumnUUID::Slice(size_t begin, size_t len) const {
     return std::make_shared<ColumnUUID>(data_->Slice(begin * 2, len * 2));
 }
 
+ColumnRef ColumnUUID::Permute(const std::vector<size_t>& indices) const {
+    CheckPermutation(indices);
+
+    // Each value is stored as two UInt64 halves.
+    const auto& data = data_->GetData();
+    std::vector<uint64_t> result(indices.size() * 2);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        result[i * 2] = data[indices[i] * 2];
+        result[i * 2 + 1] = data[indices[i] * 2 + 1];
+    }
+
+    return std::make_shared<ColumnUUID>(std::make_shared<ColumnUInt64>(std::move(result)));
+}
+
 ColumnRef ColumnUUID::CloneEmpty() const {
     return std::make_shared<ColumnUUID>();
 }
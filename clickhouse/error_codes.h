@@ -3,26 +3,42 @@
 namespace clickhouse {
 
 enum ErrorCodes {
+    CANNOT_PARSE_TEXT = 6,
+    INCORRECT_NUMBER_OF_COLUMNS = 7,
+    THERE_IS_NO_COLUMN = 8,
+    NOT_FOUND_COLUMN_IN_BLOCK = 10,
+    DUPLICATE_COLUMN = 15,
+    NO_SUCH_COLUMN_IN_TABLE = 16,
     CHECKSUM_DOESNT_MATCH = 40,
     CANNOT_PARSE_DATETIME = 41,
+    ILLEGAL_TYPE_OF_ARGUMENT = 43,
+    ILLEGAL_COLUMN = 44,
     UNKNOWN_FUNCTION = 46,
     UNKNOWN_IDENTIFIER = 47,
+    UNKNOWN_TYPE = 50,
+    TYPE_MISMATCH = 53,
     TABLE_ALREADY_EXISTS = 57,
     UNKNOWN_TABLE = 60,
     SYNTAX_ERROR = 62,
+    CANNOT_CONVERT_TYPE = 70,
     UNKNOWN_DATABASE = 81,
     DATABASE_ALREADY_EXISTS = 82,
     UNKNOWN_PACKET_FROM_CLIENT = 99,
     UNEXPECTED_PACKET_FROM_CLIENT = 101,
     RECEIVED_DATA_FOR_WRONG_QUERY_ID = 103,
+    INCORRECT_DATA = 117,
     ENGINE_REQUIRED = 119,
     READONLY = 164,
     UNKNOWN_USER = 192,
     WRONG_PASSWORD = 193,
     REQUIRED_PASSWORD = 194,
     IP_ADDRESS_NOT_ALLOWED = 195,
+    MEMORY_LIMIT_EXCEEDED = 241,
+    TOO_MANY_PARTS = 252,
     LIMIT_EXCEEDED = 290,
     UNKNOWN_DATABASE_ENGINE = 336,
+    CANNOT_INSERT_NULL_IN_ORDINARY_COLUMN = 349,
+    VIOLATED_CONSTRAINT = 469,
     UNKNOWN_EXCEPTION = 1002,
 };
 
@@ -37,6 +37,16 @@ class LZ4Error : public Error {
     using Error::Error;
 };
 
+// Query has not been completed within the time limit set by Query::SetTimeout().
+class TimeoutError : public Error {
+    using Error::Error;
+};
+
+// Insert spool has no room for a block within InsertSpoolOptions::max_disk_usage.
+class SpoolOverflowError : public Error {
+    using Error::Error;
+};
+
 // Exception received from server.
 class ServerException : public Error {
 public:
@@ -0,0 +1,232 @@
+#include "insert_router.h"
+#include "columns/string.h"
+
+#include <cityhash/city.h>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <type_traits>
+
+namespace clickhouse {
+
+namespace {
+
+/// Same as intHash64() of ClickHouse.
+inline uint64_t IntHash64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/// Same as IntHash64Impl::apply() of ClickHouse, used for both intHash64() and cityHash64() of integers.
+inline uint64_t IntHash64WithSalt(uint64_t x) {
+    return IntHash64(x ^ 0x4CF2D2BAAE6DA887ULL);
+}
+
+/**
+ * Integers are converted to UInt64 differently:
+ *  - the value of Identity is taken as unsigned integer of the same width;
+ *  - intHash64() converts the value to UInt64, extending its sign;
+ *  - cityHash64() takes the bytes of the value.
+ */
+template <typename T>
+void HashIntegers(const std::vector<T>& data, ShardingFunction function, std::vector<uint64_t>& hashes) {
+    using UnsignedT = std::make_unsigned_t<T>;
+
+    switch (function) {
+        case ShardingFunction::Identity:
+            for (size_t i = 0; i < data.size(); ++i) {
+                hashes[i] = static_cast<UnsignedT>(data[i]);
+            }
+            break;
+        case ShardingFunction::IntHash64:
+            for (size_t i = 0; i < data.size(); ++i) {
+                hashes[i] = IntHash64WithSalt(static_cast<uint64_t>(data[i]));
+            }
+            break;
+        case ShardingFunction::CityHash64:
+            for (size_t i = 0; i < data.size(); ++i) {
+                hashes[i] = IntHash64WithSalt(static_cast<UnsignedT>(data[i]));
+            }
+            break;
+    }
+}
+
+template <typename T>
+bool TryHashIntegers(const Column& key, ShardingFunction function, std::vector<uint64_t>& hashes) {
+    if (const auto col = dynamic_cast<const ColumnVector<T>*>(&key)) {
+        HashIntegers(col->GetData(), function, hashes);
+        return true;
+    }
+    return false;
+}
+
+/// Integer types, which are stored in columns of other kinds.
+bool IsSignedInteger(Type::Code code) {
+    return code == Type::Enum8 || code == Type::Enum16 || code == Type::Date32;
+}
+
+bool IsUnsignedInteger(Type::Code code) {
+    return code == Type::Date || code == Type::DateTime || code == Type::IPv4;
+}
+
+bool IsString(const Type& type) {
+    switch (type.GetCode()) {
+        case Type::String:
+        case Type::FixedString:
+            return true;
+        case Type::LowCardinality:
+            return IsString(*type.As<LowCardinalityType>()->GetNestedType());
+        case Type::Nullable:
+            return IsString(*type.As<NullableType>()->GetNestedType());
+        default:
+            return false;
+    }
+}
+
+/// Hashes integers of any column through ItemView.
+void HashItems(const Column& key, ShardingFunction function, std::vector<uint64_t>& hashes) {
+    const bool is_signed = IsSignedInteger(key.Type()->GetCode());
+
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        const auto data = key.GetItem(i).data;
+
+        uint64_t value = 0;
+        std::memcpy(&value, data.data(), std::min(data.size(), sizeof(value)));
+
+        if (function == ShardingFunction::IntHash64 && is_signed && data.size() < sizeof(value) &&
+            (static_cast<uint8_t>(data.back()) & 0x80)) {
+            value |= ~uint64_t(0) << (data.size() * 8);
+        }
+
+        hashes[i] = function == ShardingFunction::Identity ? value : IntHash64WithSalt(value);
+    }
+}
+
+}
+
+InsertRouter::InsertRouter(std::vector<Shard> shards, std::string key_column, ShardingFunction function)
+    : shards_(std::move(shards))
+    , key_column_(std::move(key_column))
+    , function_(function)
+    , clients_(shards_.size())
+{
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        slot_to_shard_.insert(slot_to_shard_.end(), shards_[i].weight, i);
+    }
+    if (slot_to_shard_.empty()) {
+        throw ValidationError("InsertRouter requires at least one shard with non-zero weight");
+    }
+}
+
+InsertRouter::~InsertRouter() = default;
+
+std::vector<size_t> InsertRouter::SelectShards(const Column& key) const {
+    const auto code = key.Type()->GetCode();
+    std::vector<uint64_t> hashes(key.Size());
+
+    if (TryHashIntegers<uint8_t>(key, function_, hashes) ||
+        TryHashIntegers<uint16_t>(key, function_, hashes) ||
+        TryHashIntegers<uint32_t>(key, function_, hashes) ||
+        TryHashIntegers<uint64_t>(key, function_, hashes) ||
+        TryHashIntegers<int8_t>(key, function_, hashes) ||
+        TryHashIntegers<int16_t>(key, function_, hashes) ||
+        TryHashIntegers<int32_t>(key, function_, hashes) ||
+        TryHashIntegers<int64_t>(key, function_, hashes)) {
+        // Done.
+    } else if (IsSignedInteger(code) || IsUnsignedInteger(code)) {
+        HashItems(key, function_, hashes);
+    } else if (code != Type::Nullable && IsString(*key.Type())) {
+        if (function_ != ShardingFunction::CityHash64) {
+            throw ValidationError("only cityHash64 may be used for sharding key of type " + key.Type()->GetName());
+        }
+        if (const auto strings = dynamic_cast<const ColumnString*>(&key)) {
+            const char* chars = strings->GetChars().data();
+            const auto& offsets = strings->GetOffsets();
+            for (size_t i = 0; i < hashes.size(); ++i) {
+                hashes[i] = CityHash64(chars + offsets[i], offsets[i + 1] - offsets[i]);
+            }
+        } else {
+            for (size_t i = 0; i < hashes.size(); ++i) {
+                const auto data = key.GetItem(i).data;
+                hashes[i] = CityHash64(data.data(), data.size());
+            }
+        }
+    } else {
+        throw ValidationError("unsupported type of sharding key: " + key.Type()->GetName());
+    }
+
+    std::vector<size_t> selector(hashes.size());
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        selector[i] = slot_to_shard_[hashes[i] % slot_to_shard_.size()];
+    }
+    return selector;
+}
+
+std::vector<Block> InsertRouter::Scatter(const Block& block) const {
+    ColumnRef key;
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        if (bi.Name() == key_column_) {
+            key = bi.Column();
+            break;
+        }
+    }
+    if (!key) {
+        throw ValidationError("block has no sharding key column '" + key_column_ + "'");
+    }
+
+    const auto selector = SelectShards(*key);
+
+    std::vector<Block> result(shards_.size());
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        const auto parts = bi.Column()->Scatter(selector, shards_.size());
+        for (size_t s = 0; s < shards_.size(); ++s) {
+            result[s].AppendColumn(bi.Name(), parts[s]);
+        }
+    }
+
+    return result;
+}
+
+void InsertRouter::Insert(const Block& block) {
+    const auto blocks = Scatter(block);
+
+    std::vector<std::exception_ptr> errors(shards_.size());
+    std::vector<std::thread> threads;
+
+    for (size_t s = 0; s < shards_.size(); ++s) {
+        if (blocks[s].GetRowCount() == 0) {
+            continue;
+        }
+
+        threads.emplace_back([this, s, &blocks, &errors] {
+            try {
+                if (!clients_[s]) {
+                    clients_[s] = std::make_unique<Client>(shards_[s].client_options);
+                }
+                clients_[s]->Insert(shards_[s].table_name, blocks[s]);
+            } catch (...) {
+                // State of the connection is unknown.
+                clients_[s].reset();
+                errors[s] = std::current_exception();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}
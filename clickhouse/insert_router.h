@@ -0,0 +1,70 @@
+#pragma once
+
+#include "client.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clickhouse {
+
+/// Function of the sharding key, which selects the shard, as in the definition of a Distributed table.
+enum class ShardingFunction {
+    /// Value of an integer key itself, like `Distributed(cluster, db, table, key)`.
+    Identity,
+    /// cityHash64(key)
+    CityHash64,
+    /// intHash64(key)
+    IntHash64,
+};
+
+struct Shard {
+    ClientOptions client_options;
+    /// Local table of the shard.
+    std::string table_name;
+    /// Part of the rows, which the shard receives, relative to other shards.
+    uint32_t weight = 1;
+};
+
+/**
+ * Inserts rows into the local tables of shards directly, bypassing a Distributed table.
+ *
+ * Rows are distributed the same way the server does it: the shard is selected
+ * by the value of the sharding function modulo total weight of shards.
+ * Only integer, Date/DateTime, Enum, String, FixedString and LowCardinality
+ * columns may be used as the sharding key.
+ *
+ * Like Client, the router is not thread-safe.
+ */
+class InsertRouter {
+public:
+    InsertRouter(std::vector<Shard> shards, std::string key_column, ShardingFunction function = ShardingFunction::CityHash64);
+    ~InsertRouter();
+
+    /// Splits rows of the block between shards, in the order of shards.
+    /// Blocks of shards, which receive no rows, are empty.
+    std::vector<Block> Scatter(const Block& block) const;
+
+    /// Inserts rows of the block into their shards, all shards at once.
+    /// Connections to shards are established on the first insert.
+    void Insert(const Block& block);
+
+    inline size_t GetShardCount() const noexcept {
+        return shards_.size();
+    }
+
+private:
+    /// Returns index of the shard for every row of the key column.
+    std::vector<size_t> SelectShards(const Column& key) const;
+
+private:
+    const std::vector<Shard> shards_;
+    const std::string key_column_;
+    const ShardingFunction function_;
+    /// Shard for every unit of the total weight.
+    std::vector<size_t> slot_to_shard_;
+    std::vector<std::unique_ptr<Client>> clients_;
+};
+
+}
@@ -0,0 +1,515 @@
+#include "insert_spool.h"
+#include "error_codes.h"
+#include "native_format.h"
+#include "revision.h"
+
+#include "base/compressed.h"
+#include "base/file.h"
+#include "base/input.h"
+#include "base/output.h"
+#include "base/platform.h"
+#include "base/wire_format.h"
+
+#include <cityhash/city.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+#if defined(_win_)
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace clickhouse {
+
+namespace {
+
+/**
+ * Layout of a record in a segment:
+ *  - UInt64 size of the payload;
+ *  - UInt64 CityHash64 of the payload;
+ *  - payload: UInt8 compression method, name of the table and block in Native format.
+ */
+constexpr size_t RECORD_HEADER_SIZE = sizeof(uint64_t) * 2;
+
+/// Errors, with which the server rejects the block itself or the table it is inserted into,
+/// so it won't be accepted next time either. Other errors (memory limit, too many parts,
+/// readonly replica, tables being loaded, etc.) may pass, the block is inserted again.
+bool IsPermanentServerError(int code) {
+    switch (code) {
+        case ErrorCodes::CANNOT_PARSE_TEXT:
+        case ErrorCodes::INCORRECT_NUMBER_OF_COLUMNS:
+        case ErrorCodes::THERE_IS_NO_COLUMN:
+        case ErrorCodes::NOT_FOUND_COLUMN_IN_BLOCK:
+        case ErrorCodes::DUPLICATE_COLUMN:
+        case ErrorCodes::NO_SUCH_COLUMN_IN_TABLE:
+        case ErrorCodes::CANNOT_PARSE_DATETIME:
+        case ErrorCodes::ILLEGAL_TYPE_OF_ARGUMENT:
+        case ErrorCodes::ILLEGAL_COLUMN:
+        case ErrorCodes::UNKNOWN_IDENTIFIER:
+        case ErrorCodes::UNKNOWN_TYPE:
+        case ErrorCodes::TYPE_MISMATCH:
+        case ErrorCodes::UNKNOWN_TABLE:
+        case ErrorCodes::SYNTAX_ERROR:
+        case ErrorCodes::CANNOT_CONVERT_TYPE:
+        case ErrorCodes::UNKNOWN_DATABASE:
+        case ErrorCodes::INCORRECT_DATA:
+        case ErrorCodes::CANNOT_INSERT_NULL_IN_ORDINARY_COLUMN:
+        case ErrorCodes::VIOLATED_CONSTRAINT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+constexpr uint8_t RECORD_UNCOMPRESSED = 0;
+constexpr uint8_t RECORD_LZ4 = 1;
+
+const char* const SEGMENT_EXTENSION = ".segment";
+/// Segments with damaged records are renamed, so they are not loaded again, but can be examined.
+const char* const CORRUPTED_EXTENSION = ".corrupted";
+
+/// Segments outlive the library, which has written them, so they are kept at the revision
+/// of native files rather than the one of the protocol, which grows with new features.
+NativeFormatSettings GetSpoolFormatSettings() {
+    NativeFormatSettings settings;
+    settings.revision = NATIVE_FILE_REVISION;
+    return settings;
+}
+
+std::string SegmentPath(const std::string& directory, uint64_t number) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu", static_cast<unsigned long long>(number));
+    return (std::filesystem::path(directory) / (name + std::string(SEGMENT_EXTENSION))).string();
+}
+
+void SyncFile(std::FILE* file) {
+#if defined(_win_)
+    if (::_commit(::_fileno(file)) != 0) {
+#else
+    if (::fsync(::fileno(file)) != 0) {
+#endif
+        throw std::system_error(errno, std::generic_category(), "can't sync spool segment");
+    }
+}
+
+/// Returns payload of the record at the current position of input, or false
+/// if there is no complete record with a valid checksum.
+bool ReadRecord(ArrayInput& input, const uint8_t** payload, size_t* size) {
+    if (input.Avail() < RECORD_HEADER_SIZE) {
+        return false;
+    }
+
+    uint64_t payload_size;
+    uint64_t checksum;
+    WireFormat::ReadFixed(input, &payload_size);
+    WireFormat::ReadFixed(input, &checksum);
+
+    if (input.Avail() < payload_size) {
+        return false;
+    }
+    if (CityHash64(reinterpret_cast<const char*>(input.Data()), payload_size) != checksum) {
+        return false;
+    }
+
+    *payload = input.Data();
+    *size = payload_size;
+    input.Skip(payload_size);
+    return true;
+}
+
+/// Returns size of the longest prefix of a segment, which consists of complete records.
+size_t ValidSegmentSize(const MappedFile& file) {
+    ArrayInput input(file.Data(), file.Size());
+    size_t valid = 0;
+
+    const uint8_t* payload;
+    size_t size;
+    while (ReadRecord(input, &payload, &size)) {
+        valid = file.Size() - input.Avail();
+    }
+    return valid;
+}
+
+Buffer MakeRecord(const std::string& table_name, const Block& block, CompressionMethod compression) {
+    Buffer record;
+    BufferOutput output(&record);
+
+    // Header is filled in when the payload is written.
+    WireFormat::WriteFixed<uint64_t>(output, 0);
+    WireFormat::WriteFixed<uint64_t>(output, 0);
+
+    if (compression == CompressionMethod::LZ4) {
+        WireFormat::WriteFixed<uint8_t>(output, RECORD_LZ4);
+        WireFormat::WriteString(output, table_name);
+
+        BufferedOutput compressed(std::make_unique<CompressedOutput>(&output));
+        WriteNativeBlock(compressed, GetSpoolFormatSettings(), block);
+        compressed.Flush();
+    } else {
+        WireFormat::WriteFixed<uint8_t>(output, RECORD_UNCOMPRESSED);
+        WireFormat::WriteString(output, table_name);
+        WriteNativeBlock(output, GetSpoolFormatSettings(), block);
+    }
+
+    const uint64_t payload_size = record.size() - RECORD_HEADER_SIZE;
+    const uint64_t checksum = CityHash64(
+        reinterpret_cast<const char*>(record.data() + RECORD_HEADER_SIZE), payload_size);
+
+    ArrayOutput header(record.data(), RECORD_HEADER_SIZE);
+    WireFormat::WriteFixed(header, payload_size);
+    WireFormat::WriteFixed(header, checksum);
+
+    return record;
+}
+
+bool ParseRecord(const uint8_t* payload, size_t size, std::string* table_name, Block* block) {
+    ArrayInput input(payload, size);
+
+    uint8_t method;
+    if (!WireFormat::ReadFixed(input, &method) || !WireFormat::ReadString(input, table_name)) {
+        return false;
+    }
+
+    if (method == RECORD_LZ4) {
+        CompressedInput compressed(&input);
+        return ReadNativeBlock(compressed, GetSpoolFormatSettings(), block);
+    }
+    if (method == RECORD_UNCOMPRESSED) {
+        return ReadNativeBlock(input, GetSpoolFormatSettings(), block);
+    }
+    return false;
+}
+
+}
+
+InsertSpool::InsertSpool(const ClientOptions& client_options, const InsertSpoolOptions& options)
+    : client_options_(client_options)
+    , options_(options)
+{
+    if (options_.directory.empty()) {
+        throw ValidationError("directory of the insert spool is not set");
+    }
+
+    Recover();
+    replayer_ = std::thread([this] { ReplayLoop(); });
+}
+
+InsertSpool::~InsertSpool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopped_ = true;
+        try {
+            SealActiveSegment();
+        } catch (...) {
+            // The segment is recovered next time the spool is opened.
+        }
+    }
+    changed_.notify_all();
+    replayer_.join();
+}
+
+void InsertSpool::Append(const std::string& table_name, const Block& block) {
+    if (block.GetRowCount() == 0) {
+        return;
+    }
+
+    const Buffer record = MakeRecord(table_name, block, options_.compression_method);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (disk_usage_ + record.size() > options_.max_disk_usage) {
+            throw SpoolOverflowError("insert spool " + options_.directory + " is full: " + std::to_string(disk_usage_) + " bytes are used");
+        }
+
+        if (!active_file_) {
+            active_ = Segment{next_segment_number_, SegmentPath(options_.directory, next_segment_number_), 0};
+            active_file_ = std::fopen(active_.path.c_str(), "wb");
+            if (!active_file_) {
+                throw std::system_error(errno, std::generic_category(), "can't create spool segment " + active_.path);
+            }
+            active_created_ = std::chrono::steady_clock::now();
+            ++next_segment_number_;
+        }
+
+        try {
+            if (std::fwrite(record.data(), 1, record.size(), active_file_) != record.size() || std::fflush(active_file_) != 0) {
+                throw std::system_error(errno, std::generic_category(), "can't write spool segment " + active_.path);
+            }
+            if (options_.sync_policy == SpoolSyncPolicy::EveryBlock) {
+                SyncFile(active_file_);
+            }
+        } catch (...) {
+            DropIncompleteRecord();
+            throw;
+        }
+
+        active_.size += record.size();
+        disk_usage_ += record.size();
+
+        if (active_.size >= options_.max_segment_size) {
+            SealActiveSegment();
+        }
+    }
+    changed_.notify_all();
+}
+
+size_t InsertSpool::DiskUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return disk_usage_;
+}
+
+bool InsertSpool::WaitUntilEmpty(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return changed_.wait_for(lock, timeout, [this] { return disk_usage_ == 0; });
+}
+
+void InsertSpool::Recover() {
+    namespace fs = std::filesystem;
+
+    fs::create_directories(options_.directory);
+
+    std::vector<Segment> segments;
+    for (const auto& entry : fs::directory_iterator(options_.directory)) {
+        const auto& path = entry.path();
+        const auto stem = path.stem().string();
+        if (!entry.is_regular_file() || path.extension() != SEGMENT_EXTENSION ||
+            stem.empty() || !std::all_of(stem.begin(), stem.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+            continue;
+        }
+        segments.push_back(Segment{std::stoull(stem), path.string(), 0});
+    }
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) { return a.number < b.number; });
+
+    for (auto& segment : segments) {
+        next_segment_number_ = segment.number + 1;
+
+        {
+            MappedFile file(segment.path);
+            segment.size = ValidSegmentSize(file);
+        }
+        if (segment.size == 0) {
+            fs::remove(segment.path);
+            continue;
+        }
+        // Drop the record, which has been written partially.
+        if (segment.size != fs::file_size(segment.path)) {
+            fs::resize_file(segment.path, segment.size);
+        }
+
+        disk_usage_ += segment.size;
+        segments_.push_back(segment);
+    }
+}
+
+void InsertSpool::SealActiveSegment() {
+    if (!active_file_) {
+        return;
+    }
+
+    std::FILE* file = active_file_;
+    active_file_ = nullptr;
+    segments_.push_back(active_);
+
+    if (options_.sync_policy != SpoolSyncPolicy::None) {
+        try {
+            SyncFile(file);
+        } catch (...) {
+            std::fclose(file);
+            throw;
+        }
+    }
+    std::fclose(file);
+}
+
+void InsertSpool::DropIncompleteRecord() {
+    namespace fs = std::filesystem;
+
+    std::fclose(active_file_);
+    active_file_ = nullptr;
+
+    // Records appended before are kept, the next one starts a new segment.
+    std::error_code ec;
+    if (active_.size == 0) {
+        fs::remove(active_.path, ec);
+        return;
+    }
+    // If the file can't be truncated, the tail is ignored by replay and dropped by recovery.
+    fs::resize_file(active_.path, active_.size, ec);
+    segments_.push_back(active_);
+    changed_.notify_all();
+}
+
+void InsertSpool::ReplayLoop() {
+    while (true) {
+        Segment segment;
+        std::exception_ptr seal_error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopped_ && segments_.empty()) {
+                if (!active_file_) {
+                    changed_.wait(lock);
+                    continue;
+                }
+                // Nothing else to insert, so the segment being written is inserted once it is old enough.
+                const auto deadline = active_created_ + options_.max_segment_age;
+                if (std::chrono::steady_clock::now() < deadline) {
+                    changed_.wait_until(lock, deadline);
+                    continue;
+                }
+                try {
+                    SealActiveSegment();
+                } catch (const std::exception&) {
+                    // Reported without the lock, as the callback may call the spool.
+                    seal_error = std::current_exception();
+                }
+            }
+            if (stopped_) {
+                return;
+            }
+            segment = segments_.front();
+        }
+
+        if (seal_error) {
+            try {
+                std::rethrow_exception(seal_error);
+            } catch (const std::exception& e) {
+                if (options_.error_callback) {
+                    options_.error_callback(std::string(), Block(), e);
+                }
+            }
+        }
+
+        bool replayed = false;
+        try {
+            replayed = ReplaySegment(segment);
+        } catch (const std::exception& e) {
+            // Segment can't be read, e.g. it has been removed or can't be mapped. It is left on the disk
+            // to be recovered when the spool is opened again, and the next one is inserted.
+            if (options_.error_callback) {
+                options_.error_callback(std::string(), Block(), e);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                segments_.pop_front();
+                disk_usage_ -= segment.size;
+            }
+            changed_.notify_all();
+            continue;
+        }
+
+        if (!replayed) {
+            return;
+        }
+
+        std::error_code ec;
+        std::filesystem::remove(segment.path, ec);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            segments_.pop_front();
+            disk_usage_ -= segment.size;
+        }
+        changed_.notify_all();
+    }
+}
+
+bool InsertSpool::ReplaySegment(const Segment& segment) {
+    std::string corruption;
+    {
+        MappedFile file(segment.path);
+        // Segment may be longer than was known when it was recovered: ignore the tail.
+        const size_t size = std::min(file.Size(), segment.size);
+        ArrayInput input(file.Data(), size);
+
+        while (!input.Exhausted()) {
+            const size_t offset = size - input.Avail();
+            const auto error_prefix = "spool segment " + segment.path + " has an invalid record at offset " + std::to_string(offset);
+
+            const uint8_t* payload;
+            size_t payload_size;
+            if (!ReadRecord(input, &payload, &payload_size)) {
+                // Records after this one can't be found.
+                corruption = error_prefix + ": checksum mismatch";
+                break;
+            }
+
+            std::string table_name;
+            Block block;
+            try {
+                if (!ParseRecord(payload, payload_size, &table_name, &block)) {
+                    throw ProtocolError(error_prefix + ": unexpected end of record");
+                }
+            } catch (const std::exception& e) {
+                if (options_.error_callback) {
+                    options_.error_callback(table_name, Block(), e);
+                }
+                continue;
+            }
+
+            if (!InsertBlock(table_name, block)) {
+                return false;
+            }
+        }
+    }
+
+    if (!corruption.empty()) {
+        const auto path = segment.path + CORRUPTED_EXTENSION;
+        std::filesystem::rename(segment.path, path);
+        if (options_.error_callback) {
+            options_.error_callback(std::string(), Block(), ProtocolError(corruption + ", the segment is kept as " + path));
+        }
+    }
+
+    return true;
+}
+
+bool InsertSpool::InsertBlock(const std::string& table_name, const Block& block) {
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopped_) {
+                return false;
+            }
+        }
+
+        try {
+            if (!client_) {
+                client_ = std::make_unique<Client>(client_options_);
+            }
+            client_->Insert(table_name, block);
+            return true;
+        } catch (const ServerException& e) {
+            client_.reset();
+            // The server has rejected the block, it won't be accepted next time either.
+            if (IsPermanentServerError(e.GetCode())) {
+                if (options_.error_callback) {
+                    options_.error_callback(table_name, block, e);
+                }
+                return true;
+            }
+        } catch (const std::system_error&) {
+            // Server is not available or the connection has been lost.
+            client_.reset();
+        } catch (const std::exception& e) {
+            // Block can't be sent (e.g. a column of the table is not supported by the client),
+            // the next attempt would fail the same way.
+            client_.reset();
+            if (options_.error_callback) {
+                options_.error_callback(table_name, block, e);
+            }
+            return true;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (changed_.wait_for(lock, options_.retry_interval, [this] { return stopped_; })) {
+            return false;
+        }
+    }
+}
+
+}
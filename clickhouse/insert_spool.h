@@ -0,0 +1,138 @@
+#pragma once
+
+#include "client.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace clickhouse {
+
+/// When data appended to the spool is forced to the disk.
+enum class SpoolSyncPolicy {
+    /// Leave it to the operating system.
+    None,
+    /// fsync() each segment when it is completed.
+    EverySegment,
+    /// fsync() after every appended block.
+    EveryBlock,
+};
+
+/// Called for a block, which has been rejected by the server for good (e.g. unknown table or mismatch of types)
+/// or can't be sent by the client (e.g. protocol errors), before it is dropped from the spool. Network errors
+/// and other errors of the server are retried as unavailability of it. It is called from the background thread
+/// of the spool without holding its lock, so it may call the spool.
+using SpoolErrorCallback = std::function<void(const std::string& table_name, const Block& block, const std::exception& error)>;
+
+struct InsertSpoolOptions {
+#define DECLARE_FIELD(name, type, setter, default_value) \
+    type name = default_value; \
+    inline auto & setter(const type& value) { \
+        name = value; \
+        return *this; \
+    }
+
+    /// Directory with segments of the spool, it is created if doesn't exist.
+    DECLARE_FIELD(directory, std::string, SetDirectory, std::string());
+    /// Segment is completed and a new one is started when it grows above this size.
+    DECLARE_FIELD(max_segment_size, size_t, SetMaxSegmentSize, 64 * 1024 * 1024);
+    /// Segment is completed after this time too, when there are no other segments to insert,
+    /// so blocks appended at a low rate are inserted with a delay, but not a segment per block.
+    DECLARE_FIELD(max_segment_age, std::chrono::milliseconds, SetMaxSegmentAge, std::chrono::seconds(1));
+    /// Total size of all segments, appending beyond it throws SpoolOverflowError.
+    DECLARE_FIELD(max_disk_usage, size_t, SetMaxDiskUsage, 1024 * 1024 * 1024);
+    DECLARE_FIELD(sync_policy, SpoolSyncPolicy, SetSyncPolicy, SpoolSyncPolicy::EverySegment);
+    /// Compression of blocks stored in the spool.
+    DECLARE_FIELD(compression_method, CompressionMethod, SetCompressionMethod, CompressionMethod::None);
+    /// Delay before the next attempt to insert, when the server is not available or fails temporarily.
+    DECLARE_FIELD(retry_interval, std::chrono::milliseconds, SetRetryInterval, std::chrono::seconds(1));
+    DECLARE_FIELD(error_callback, SpoolErrorCallback, SetErrorCallback, nullptr);
+
+#undef DECLARE_FIELD
+};
+
+/**
+ * Append-only spool of blocks on the local disk, which are inserted into the server in background.
+ *
+ * Blocks are stored in Native format, each one with a checksum, in segment files
+ * of the spool directory. A background thread inserts them in the order they were
+ * appended, waiting for the server when it is not available, and removes segments
+ * which have been inserted completely.
+ *
+ * Blocks left in the directory (e.g. after a restart of the application) are inserted
+ * when the spool is opened again. A torn record at the end of a segment is discarded.
+ * A segment with a damaged record is renamed to *.corrupted and left in the directory.
+ * Delivery is at-least-once: blocks of a segment, which has not been completely
+ * inserted before the spool was closed, are inserted again.
+ */
+class InsertSpool {
+public:
+    InsertSpool(const ClientOptions& client_options, const InsertSpoolOptions& options);
+    ~InsertSpool();
+
+    InsertSpool(const InsertSpool&) = delete;
+    InsertSpool& operator=(const InsertSpool&) = delete;
+
+    /// Stores block to be inserted into the table.
+    void Append(const std::string& table_name, const Block& block);
+
+    /// Total size of segments, which are not inserted yet.
+    size_t DiskUsage() const;
+
+    /// Waits until all appended blocks are inserted, returns false on timeout.
+    bool WaitUntilEmpty(std::chrono::milliseconds timeout);
+
+private:
+    struct Segment {
+        uint64_t number = 0;
+        std::string path;
+        size_t size = 0;
+    };
+
+    /// Loads existing segments from the directory.
+    void Recover();
+
+    /// Completes the segment being written.
+    void SealActiveSegment();
+
+    /// Closes the segment being written after a failed write, truncating it to the complete records.
+    void DropIncompleteRecord();
+
+    /// Inserts blocks of segments until the spool is closed.
+    void ReplayLoop();
+
+    /// Inserts blocks of a completed segment, returns false if the spool is closed.
+    bool ReplaySegment(const Segment& segment);
+
+    /// Inserts block, retrying until it succeeds, fails permanently or the spool is closed.
+    bool InsertBlock(const std::string& table_name, const Block& block);
+
+private:
+    const ClientOptions client_options_;
+    const InsertSpoolOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    /// Completed segments in order of their numbers.
+    std::deque<Segment> segments_;
+    /// Segment being written.
+    std::FILE* active_file_ = nullptr;
+    Segment active_;
+    std::chrono::steady_clock::time_point active_created_;
+    uint64_t next_segment_number_ = 0;
+    size_t disk_usage_ = 0;
+    bool stopped_ = false;
+
+    std::unique_ptr<Client> client_;
+    std::thread replayer_;
+};
+
+}
@@ -0,0 +1,99 @@
+#include "native_file.h"
+#include "native_format.h"
+#include "revision.h"
+
+#include "base/compressed.h"
+#include "base/output.h"
+
+#include <cerrno>
+#include <memory>
+#include <system_error>
+
+namespace clickhouse {
+
+namespace {
+
+NativeFormatSettings GetFileFormatSettings() {
+    NativeFormatSettings settings;
+    settings.revision = NATIVE_FILE_REVISION;
+    return settings;
+}
+
+}
+
+NativeFileWriter::NativeFileWriter(const std::string& path, CompressionMethod compression)
+    : path_(path)
+    , compression_(compression)
+    , file_(path, std::ios::binary | std::ios::trunc)
+{
+    if (!file_) {
+        throw std::system_error(errno, std::generic_category(), "can't open file " + path_);
+    }
+}
+
+void NativeFileWriter::Write(const Block& block) {
+    buffer_.clear();
+    BufferOutput output(&buffer_);
+
+    if (compression_ == CompressionMethod::LZ4) {
+        // Flushing after every block makes it end at a frame boundary.
+        BufferedOutput buffered(std::make_unique<CompressedOutput>(&output));
+        WriteNativeBlock(buffered, GetFileFormatSettings(), block);
+        buffered.Flush();
+    } else {
+        WriteNativeBlock(output, GetFileFormatSettings(), block);
+    }
+
+    file_.write(reinterpret_cast<const char*>(buffer_.data()), buffer_.size());
+    if (!file_) {
+        throw std::system_error(std::make_error_code(std::errc::io_error), "can't write file " + path_);
+    }
+}
+
+void NativeFileWriter::Flush() {
+    file_.flush();
+    if (!file_) {
+        throw std::system_error(std::make_error_code(std::errc::io_error), "can't write file " + path_);
+    }
+}
+
+NativeFileReader::NativeFileReader(const std::string& path, CompressionMethod compression)
+    : path_(path)
+    , compression_(compression)
+    , file_(path)
+    , input_(file_.Data(), file_.Size())
+{
+}
+
+bool NativeFileReader::Next(Block* block) {
+    if (input_.Exhausted()) {
+        return false;
+    }
+
+    const auto error_prefix = "native file " + path_ + " has an invalid block at offset " + std::to_string(Offset());
+
+    Block result;
+    try {
+        bool ok;
+        if (compression_ == CompressionMethod::LZ4) {
+            CompressedInput compressed(&input_);
+            ok = ReadNativeBlock(compressed, GetFileFormatSettings(), &result);
+        } else {
+            ok = ReadNativeBlock(input_, GetFileFormatSettings(), &result);
+        }
+        if (!ok) {
+            throw ValidationError(error_prefix + ": unexpected end of file");
+        }
+    } catch (const LZ4Error& e) {
+        throw ValidationError(error_prefix + ": " + e.what());
+    }
+
+    *block = std::move(result);
+    return true;
+}
+
+void NativeFileReader::Rewind() {
+    input_.Reset(file_.Data(), file_.Size());
+}
+
+}
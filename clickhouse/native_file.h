@@ -0,0 +1,70 @@
+#pragma once
+
+#include "block.h"
+#include "client.h"
+
+#include "base/buffer.h"
+#include "base/file.h"
+#include "base/input.h"
+
+#include <fstream>
+#include <string>
+
+namespace clickhouse {
+
+/**
+ * Writes blocks to a file in the form they are sent over the wire,
+ * in Native format of protocol revision NATIVE_FILE_REVISION.
+ *
+ * With CompressionMethod::LZ4 every block ends at a frame boundary,
+ * so the file may be inserted with Client::InsertNativeFile().
+ */
+class NativeFileWriter {
+public:
+    /// Creates the file or truncates an existing one.
+    explicit NativeFileWriter(const std::string& path, CompressionMethod compression = CompressionMethod::None);
+
+    NativeFileWriter(const NativeFileWriter&) = delete;
+    NativeFileWriter& operator=(const NativeFileWriter&) = delete;
+
+    /// Appends block to the end of the file.
+    void Write(const Block& block);
+
+    /// Flushes written blocks to the file.
+    void Flush();
+
+private:
+    const std::string path_;
+    const CompressionMethod compression_;
+    std::ofstream file_;
+    Buffer buffer_;
+};
+
+/**
+ * Reads blocks from a file written with NativeFileWriter (or saved from Client::SelectRaw()).
+ * The file is mapped into memory and blocks are loaded directly from the mapping.
+ */
+class NativeFileReader {
+public:
+    /// `compression` must be the same the file was written with.
+    explicit NativeFileReader(const std::string& path, CompressionMethod compression = CompressionMethod::None);
+
+    /// Reads the next block, returns false at the end of the file.
+    bool Next(Block* block);
+
+    /// Starts reading from the beginning of the file again.
+    void Rewind();
+
+    /// Position of the next block in the file.
+    inline size_t Offset() const noexcept {
+        return file_.Size() - input_.Avail();
+    }
+
+private:
+    const std::string path_;
+    const CompressionMethod compression_;
+    MappedFile file_;
+    ArrayInput input_;
+};
+
+}
@@ -0,0 +1,250 @@
+#include "native_format.h"
+#include "exceptions.h"
+#include "revision.h"
+
+#include "base/input.h"
+#include "base/output.h"
+#include "base/wire_format.h"
+
+#include "columns/lowcardinality.h"
+#include "columns/nullable.h"
+#include "columns/sparse.h"
+#include "columns/string.h"
+#include "columns/tuple.h"
+
+#include <string>
+#include <vector>
+
+namespace clickhouse {
+
+namespace {
+
+/// Kinds of column serialization.
+enum SerializationKind : uint8_t {
+    Default = 0,
+    Sparse  = 1,
+};
+
+/// Types with serialization info of their own, which includes kinds of elements.
+bool IsTupleLike(const Type& type) {
+    return type.GetCode() == Type::Tuple || type.GetCode() == Type::Point;
+}
+
+std::vector<TypeRef> GetTupleElements(const TypeRef& type) {
+    if (type->GetCode() == Type::Point) {
+        return {Type::CreateSimple<double>(), Type::CreateSimple<double>()};
+    }
+    return type->As<TupleType>()->GetTupleType();
+}
+
+/// Only columns of simple types may be sent in sparse serialization.
+bool SupportsSparseSerialization(const Type& type) {
+    switch (type.GetCode()) {
+        case Type::Void:
+        case Type::Array:
+        case Type::Nullable:
+        case Type::Tuple:
+        case Type::LowCardinality:
+        case Type::Map:
+        case Type::Point:
+        case Type::Ring:
+        case Type::Polygon:
+        case Type::MultiPolygon:
+            return false;
+        default:
+            return true;
+    }
+}
+
+/// Reads kinds of serialization of the column and all elements of tuples (in depth-first order).
+bool ReadSerializationKinds(InputStream& input, const TypeRef& type, std::vector<uint8_t>* kinds) {
+    uint8_t kind;
+    if (!WireFormat::ReadFixed(input, &kind)) {
+        return false;
+    }
+    kinds->push_back(kind);
+
+    if (IsTupleLike(*type)) {
+        for (const auto& element : GetTupleElements(type)) {
+            if (!ReadSerializationKinds(input, element, kinds)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void WriteSerializationKinds(OutputStream& output, const TypeRef& type, SerializationKind kind) {
+    WireFormat::WriteFixed<uint8_t>(output, kind);
+
+    if (IsTupleLike(*type)) {
+        for (const auto& element : GetTupleElements(type)) {
+            WriteSerializationKinds(output, element, SerializationKind::Default);
+        }
+    }
+}
+
+/// Dictionary-encodes String and FixedString columns (Nullable too) with the hash table of ColumnLowCardinality,
+/// if the column of the same name is LowCardinality of the same type in the structure.
+ColumnRef EncodeLowCardinality(const ColumnRef& column, const std::string& name, const Block& structure) {
+    const Column* values = column.get();
+    if (auto nullable = column->As<ColumnNullable>()) {
+        values = nullable->Nested().get();
+    }
+    if (!dynamic_cast<const ColumnString*>(values) && !dynamic_cast<const ColumnFixedString*>(values)) {
+        return column;
+    }
+
+    for (size_t i = 0; i < structure.GetColumnCount(); ++i) {
+        if (structure.GetColumnName(i) != name) {
+            continue;
+        }
+
+        const auto type = structure[i]->Type();
+        if (type->GetCode() == Type::LowCardinality && type->As<LowCardinalityType>()->GetNestedType()->IsEqual(column->Type())) {
+            auto encoded = std::make_shared<ColumnLowCardinality>(column->CloneEmpty());
+            encoded->AppendFrom(*column);
+            return encoded;
+        }
+        break;
+    }
+    return column;
+}
+
+}
+
+bool ReadNativeBlock(InputStream& input, const NativeFormatSettings& settings, Block* block) {
+    // Additional information about block.
+    if (settings.revision >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
+        uint64_t num;
+        BlockInfo info;
+
+        // BlockInfo
+        if (!WireFormat::ReadUInt64(input, &num)) {
+            return false;
+        }
+        if (!WireFormat::ReadFixed(input, &info.is_overflows)) {
+            return false;
+        }
+        if (!WireFormat::ReadUInt64(input, &num)) {
+            return false;
+        }
+        if (!WireFormat::ReadFixed(input, &info.bucket_num)) {
+            return false;
+        }
+        if (!WireFormat::ReadUInt64(input, &num)) {
+            return false;
+        }
+
+        block->SetInfo(std::move(info));
+    }
+
+    uint64_t num_columns = 0;
+    uint64_t num_rows = 0;
+
+    if (!WireFormat::ReadUInt64(input, &num_columns)) {
+        return false;
+    }
+    if (!WireFormat::ReadUInt64(input, &num_rows)) {
+        return false;
+    }
+
+    std::string name;
+    std::string type;
+    for (size_t i = 0; i < num_columns; ++i) {
+        if (!WireFormat::ReadString(input, &name)) {
+            return false;
+        }
+        if (!WireFormat::ReadString(input, &type)) {
+            return false;
+        }
+
+        if (ColumnRef col = CreateColumnByType(type, settings.create_column)) {
+            if (settings.revision >= DBMS_MIN_REVISION_WITH_CUSTOM_SERIALIZATION) {
+                uint8_t has_custom;
+                if (!WireFormat::ReadFixed(input, &has_custom)) {
+                    return false;
+                }
+
+                std::vector<uint8_t> kinds;
+                if (has_custom && !ReadSerializationKinds(input, col->Type(), &kinds)) {
+                    return false;
+                }
+                for (size_t k = 0; k < kinds.size(); ++k) {
+                    if (kinds[k] == SerializationKind::Default) {
+                        continue;
+                    }
+                    if (kinds[k] != SerializationKind::Sparse) {
+                        throw UnimplementedError("unsupported serialization kind " + std::to_string(kinds[k]) + " of column '" + name + "'");
+                    }
+                    if (k != 0) {
+                        throw UnimplementedError("sparse serialization of tuple elements is not supported, column '" + name + "'");
+                    }
+                    col = std::make_shared<ColumnSparse>(col);
+                }
+            }
+
+            if (num_rows && !col->Load(&input, num_rows)) {
+                throw ProtocolError("can't load column '" + name + "' of type " + type);
+            }
+
+            if (auto sparse = col->As<ColumnSparse>(); sparse && !settings.keep_sparse_columns) {
+                col = sparse->Dense();
+            }
+
+            block->AppendColumn(name, col);
+        } else {
+            throw UnimplementedError(std::string("unsupported column type: ") + type);
+        }
+    }
+
+    return true;
+}
+
+void WriteNativeBlock(OutputStream& output, const NativeFormatSettings& settings, const Block& block) {
+    // Additional information about block.
+    if (settings.revision >= DBMS_MIN_REVISION_WITH_BLOCK_INFO) {
+        WireFormat::WriteUInt64(output, 1);
+        WireFormat::WriteFixed<uint8_t>(output, block.Info().is_overflows);
+        WireFormat::WriteUInt64(output, 2);
+        WireFormat::WriteFixed<int32_t>(output, block.Info().bucket_num);
+        WireFormat::WriteUInt64(output, 0);
+    }
+
+    WireFormat::WriteUInt64(output, block.GetColumnCount());
+    WireFormat::WriteUInt64(output, block.GetRowCount());
+
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        ColumnRef col = bi.Column();
+        if (settings.low_cardinality_structure) {
+            col = EncodeLowCardinality(col, bi.Name(), *settings.low_cardinality_structure);
+        }
+
+        WireFormat::WriteString(output, bi.Name());
+        WireFormat::WriteString(output, col->Type()->GetName());
+
+        if (auto sparse = col->As<ColumnSparse>()) {
+            if (settings.revision < DBMS_MIN_REVISION_WITH_SPARSE_SERIALIZATION || !SupportsSparseSerialization(*sparse->Type())) {
+                col = sparse->Dense();
+            }
+        }
+
+        if (settings.revision >= DBMS_MIN_REVISION_WITH_CUSTOM_SERIALIZATION) {
+            const bool has_custom = col->As<ColumnSparse>() != nullptr;
+            WireFormat::WriteFixed<uint8_t>(output, has_custom);
+            if (has_custom) {
+                WriteSerializationKinds(output, col->Type(), SerializationKind::Sparse);
+            }
+        }
+
+        // Empty columns are not serialized and occupy exactly 0 bytes.
+        // ref https://github.com/ClickHouse/ClickHouse/blob/39b37a3240f74f4871c8c1679910e065af6bea19/src/Formats/NativeWriter.cpp#L163
+        const bool containsData = block.GetRowCount() > 0;
+        if (containsData) {
+            col->Save(&output);
+        }
+    }
+    output.Flush();
+}
+
+}
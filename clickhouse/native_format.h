@@ -0,0 +1,31 @@
+#pragma once
+
+#include "block.h"
+#include "columns/factory.h"
+
+#include <cstdint>
+
+namespace clickhouse {
+
+class InputStream;
+class OutputStream;
+
+/// Parameters of block serialization in Native format.
+struct NativeFormatSettings {
+    /// Protocol revision, which defines presence of block info and of serialization kinds.
+    uint64_t revision = 0;
+    CreateColumnByTypeSettings create_column;
+    /// Don't convert columns in sparse serialization to ordinary ones.
+    bool keep_sparse_columns = false;
+    /// Structure of the table, which the block is written into. String and FixedString columns
+    /// (Nullable too), which are LowCardinality of the same type in the structure, are dictionary-encoded.
+    const Block* low_cardinality_structure = nullptr;
+};
+
+/// Reads block in Native format, returns false if input ended prematurely.
+bool ReadNativeBlock(InputStream& input, const NativeFormatSettings& settings, Block* block);
+
+/// Writes block in Native format.
+void WriteNativeBlock(OutputStream& output, const NativeFormatSettings& settings, const Block& block);
+
+}
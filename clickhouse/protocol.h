@@ -22,6 +22,9 @@ namespace clickhouse {
                                          /// This is such an inverted logic, where server sends requests
                                          /// And client returns back response
             ProfileEvents        = 14,   /// Packet with profile events from server.
+            MergeTreeAllRangesAnnouncement = 15, /// Parallel replicas only, never sent to clients.
+            MergeTreeReadTaskRequest = 16,       /// Parallel replicas only, never sent to clients.
+            TimezoneUpdate       = 17,   /// Session timezone has been changed.
         };
     }
 
@@ -3,14 +3,17 @@
 #include "block.h"
 #include "server_exception.h"
 
+#include "base/compressed.h"
 #include "base/open_telemetry.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace clickhouse {
 
@@ -26,6 +29,23 @@ struct QuerySettingsField {
 
 using QuerySettings = std::unordered_map<std::string, QuerySettingsField>;
 
+/// Client-side data, that is available to the query as a temporary table with the given name.
+struct ExternalTable {
+    std::string name;
+    Block data;
+};
+
+using ExternalTables = std::vector<ExternalTable>;
+
+/// What to do with a query, that has been canceled because of its timeout.
+enum class QueryCancelPolicy {
+    /// Read and discard everything the server sends until it acknowledges cancellation.
+    Drain,
+    /// Reset the connection as soon as the server sends more data,
+    /// or does not acknowledge cancellation within ClientOptions::query_cancel_timeout.
+    FastAbort,
+};
+
 struct Profile {
     uint64_t rows = 0;
     uint64_t blocks = 0;
@@ -40,8 +60,18 @@ struct Progress {
     uint64_t rows = 0;
     uint64_t bytes = 0;
     uint64_t total_rows = 0;
+    uint64_t total_bytes = 0;
     uint64_t written_rows = 0;
     uint64_t written_bytes = 0;
+    uint64_t elapsed_ns = 0;
+};
+
+
+/// Data block as it has been received from server: compressed frames with the block in Native format.
+struct RawBlock {
+    size_t columns = 0;
+    size_t rows = 0;
+    CompressedFrames frames;
 };
 
 
@@ -77,6 +107,7 @@ using ExceptionCallback        = std::function<void(const Exception& e)>;
 using ProgressCallback         = std::function<void(const Progress& progress)>;
 using SelectCallback           = std::function<void(const Block& block)>;
 using SelectCancelableCallback = std::function<bool(const Block& block)>;
+using SelectRawCallback        = std::function<void(const RawBlock& block)>;
 using SelectServerLogCallback  = std::function<bool(const Block& block)>;
 using ProfileEventsCallback    = std::function<bool(const Block& block)>;
 
@@ -123,6 +154,39 @@ public:
         return *this;
     }
 
+    inline const ExternalTables& GetExternalTables() const {
+        return external_tables_;
+    }
+
+    /// Attach client-side data to the query, it can be referred to by the name,
+    /// e.g. `SELECT ... WHERE id IN name` or `... JOIN name USING (id)`.
+    /// Blocks with the same name are appended to the same table.
+    inline Query& AddExternalTable(const std::string& name, const Block& data) {
+        external_tables_.push_back(ExternalTable{name, data});
+        return *this;
+    }
+
+    inline const std::optional<std::chrono::milliseconds>& GetTimeout() const {
+        return timeout_;
+    }
+
+    /// Set time limit for the whole query execution, measured from the moment the query is sent.
+    /// When the time is out, the query is canceled and TimeoutError is thrown.
+    inline Query& SetTimeout(std::chrono::milliseconds timeout) {
+        timeout_ = timeout;
+        return *this;
+    }
+
+    inline QueryCancelPolicy GetCancelPolicy() const {
+        return cancel_policy_;
+    }
+
+    /// Set how a query that has exceeded its timeout is canceled.
+    inline Query& SetCancelPolicy(QueryCancelPolicy policy) {
+        cancel_policy_ = policy;
+        return *this;
+    }
+
     /// Set handler for receiving result data.
     inline Query& OnData(SelectCallback cb) {
         select_cb_ = std::move(cb);
@@ -211,6 +275,9 @@ private:
     const std::string query_id_;
     std::optional<open_telemetry::TracingContext> tracing_context_;
     QuerySettings query_settings_;
+    ExternalTables external_tables_;
+    std::optional<std::chrono::milliseconds> timeout_;
+    QueryCancelPolicy cancel_policy_ = QueryCancelPolicy::Drain;
     ExceptionCallback exception_cb_;
     ProgressCallback progress_cb_;
     SelectCallback select_cb_;
@@ -0,0 +1,37 @@
+#pragma once
+
+#define DBMS_MIN_REVISION_WITH_TEMPORARY_TABLES         50264
+#define DBMS_MIN_REVISION_WITH_TOTAL_ROWS_IN_PROGRESS   51554
+#define DBMS_MIN_REVISION_WITH_BLOCK_INFO               51903
+#define DBMS_MIN_REVISION_WITH_CLIENT_INFO              54032
+#define DBMS_MIN_REVISION_WITH_SERVER_TIMEZONE          54058
+#define DBMS_MIN_REVISION_WITH_QUOTA_KEY_IN_CLIENT_INFO 54060
+//#define DBMS_MIN_REVISION_WITH_TABLES_STATUS            54226
+#define DBMS_MIN_REVISION_WITH_TIME_ZONE_PARAMETER_IN_DATETIME_DATA_TYPE 54337
+#define DBMS_MIN_REVISION_WITH_SERVER_DISPLAY_NAME      54372
+#define DBMS_MIN_REVISION_WITH_VERSION_PATCH            54401
+#define DBMS_MIN_REVISION_WITH_LOW_CARDINALITY_TYPE     54405
+#define DBMS_MIN_REVISION_WITH_COLUMN_DEFAULTS_METADATA 54410
+#define DBMS_MIN_REVISION_WITH_CLIENT_WRITE_INFO        54420
+#define DBMS_MIN_REVISION_WITH_SETTINGS_SERIALIZED_AS_STRINGS 54429
+#define DBMS_MIN_REVISION_WITH_INTERSERVER_SECRET       54441
+#define DBMS_MIN_REVISION_WITH_OPENTELEMETRY            54442
+#define DBMS_MIN_REVISION_WITH_DISTRIBUTED_DEPTH        54448
+#define DBMS_MIN_REVISION_WITH_INITIAL_QUERY_START_TIME 54449
+#define DBMS_MIN_REVISION_WITH_INCREMENTAL_PROFILE_EVENTS 54451
+#define DBMS_MIN_REVISION_WITH_PARALLEL_REPLICAS        54453
+#define DBMS_MIN_REVISION_WITH_CUSTOM_SERIALIZATION     54454
+#define DBMS_MIN_REVISION_WITH_ADDENDUM                 54458
+#define DBMS_MIN_REVISION_WITH_QUOTA_KEY                54458
+#define DBMS_MIN_REVISION_WITH_PARAMETERS               54459
+#define DBMS_MIN_REVISION_WITH_SERVER_QUERY_TIME_IN_PROGRESS 54460
+#define DBMS_MIN_REVISION_WITH_PASSWORD_COMPLEXITY_RULES 54461
+#define DBMS_MIN_REVISION_WITH_INTERSERVER_SECRET_V2    54462
+#define DBMS_MIN_REVISION_WITH_TOTAL_BYTES_IN_PROGRESS  54463
+#define DBMS_MIN_REVISION_WITH_TIMEZONE_UPDATES         54464
+#define DBMS_MIN_REVISION_WITH_SPARSE_SERIALIZATION     54465
+
+#define REVISION  DBMS_MIN_REVISION_WITH_SPARSE_SERIALIZATION
+
+// Native files are written in the format of this revision, which doesn't change along with REVISION.
+#define NATIVE_FILE_REVISION  DBMS_MIN_REVISION_WITH_SPARSE_SERIALIZATION
@@ -216,6 +216,65 @@ TYPED_TEST(GenericColumnTest, Slice) {
     // TODO: slices of different sizes
 }
 
+TYPED_TEST(GenericColumnTest, Filter) {
+    auto [column, values] = this->MakeColumnWithValues(100);
+
+    std::vector<uint8_t> mask(values.size());
+    std::decay_t<decltype(values)> expected;
+    for (size_t i = 0; i < values.size(); ++i) {
+        mask[i] = i % 3 == 0;
+        if (mask[i]) {
+            expected.push_back(values[i]);
+        }
+    }
+
+    auto filtered = column->Filter(mask)->template AsStrict<typename TestFixture::ColumnType>();
+    EXPECT_EQ(column->GetType(), filtered->GetType());
+    EXPECT_TRUE(CompareRecursive(expected, *filtered));
+
+    EXPECT_THROW(column->Filter(std::vector<uint8_t>(values.size() + 1)), ValidationError);
+}
+
+TYPED_TEST(GenericColumnTest, Permute) {
+    auto [column, values] = this->MakeColumnWithValues(100);
+
+    // Reversed rows, the first one is repeated and the last one is omitted.
+    std::vector<size_t> indices;
+    std::decay_t<decltype(values)> expected;
+    for (size_t i = values.size() - 1; i > 0; --i) {
+        indices.push_back(i - 1);
+        expected.push_back(values[i - 1]);
+    }
+    indices.push_back(0);
+    expected.push_back(values[0]);
+
+    auto permuted = column->Permute(indices)->template AsStrict<typename TestFixture::ColumnType>();
+    EXPECT_EQ(column->GetType(), permuted->GetType());
+    EXPECT_TRUE(CompareRecursive(expected, *permuted));
+
+    EXPECT_THROW(column->Permute({values.size()}), ValidationError);
+}
+
+TYPED_TEST(GenericColumnTest, Scatter) {
+    auto [column, values] = this->MakeColumnWithValues(100);
+
+    std::vector<size_t> selector(values.size());
+    std::vector<std::decay_t<decltype(values)>> expected(3);
+    for (size_t i = 0; i < values.size(); ++i) {
+        selector[i] = (i * 7) % 3;
+        expected[selector[i]].push_back(values[i]);
+    }
+
+    const auto parts = column->Scatter(selector, 3);
+    ASSERT_EQ(3u, parts.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        auto part = parts[i]->template AsStrict<typename TestFixture::ColumnType>();
+        EXPECT_TRUE(CompareRecursive(expected[i], *part));
+    }
+
+    EXPECT_THROW(column->Scatter(selector, 2), ValidationError);
+}
+
 TYPED_TEST(GenericColumnTest, CloneEmpty) {
     auto [column, values] = this->MakeColumnWithValues(100);
     EXPECT_EQ(values.size(), column->Size());
@@ -236,6 +295,19 @@ TYPED_TEST(GenericColumnTest, Clear) {
     EXPECT_EQ(0u, column->Size());
 }
 
+TYPED_TEST(GenericColumnTest, Reserve) {
+    auto [column, values] = this->MakeColumnWithValues(100);
+
+    column->Reserve(values.size() * 10);
+    EXPECT_EQ(values.size(), column->Size());
+    EXPECT_TRUE(CompareRecursive(values, *column));
+
+    // Appending after Reserve() works as usual.
+    auto [other, other_values] = this->MakeColumnWithValues(100);
+    column->Append(other);
+    EXPECT_EQ(values.size() + other_values.size(), column->Size());
+}
+
 TYPED_TEST(GenericColumnTest, Swap) {
     auto [column_A, values] = this->MakeColumnWithValues(100);
     auto column_B = this->MakeColumn();
@@ -40,13 +40,12 @@ TEST(ArrayOfLowCardinality, Serialization) {
     });
 
     // The serialization data was extracted from a successful insert.
-    // When compared to what Clickhouse/NativeWriter does for the same fields, the only differences are the index type and indexes.
-    // Since we are setting a different index type in clickhouse-cpp, it's expected to have different indexes.
+    // When compared to what Clickhouse/NativeWriter does for the same fields, the only difference is the indexes,
+    // since clickhouse-cpp keeps the default item in the dictionary.
     const std::vector<uint8_t> expectedSerialization {
         0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00,
-        0x00, 0x00, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x61, 0x61,
-        0x02, 0x62, 0x62, 0x02, 0x63, 0x63, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
-        0x03, 0x00, 0x00, 0x00
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x61, 0x61,
+        0x02, 0x62, 0x62, 0x02, 0x63, 0x63, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03
     };
 
     Buffer buf;
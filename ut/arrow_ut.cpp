@@ -0,0 +1,332 @@
+#include <clickhouse/arrow.h>
+#include <clickhouse/client.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+using namespace clickhouse;
+
+namespace {
+
+template <typename T>
+const T* GetBuffer(const ArrowArray& array, size_t index) {
+    return static_cast<const T*>(array.buffers[index]);
+}
+
+bool IsValid(const ArrowArray& array, size_t row) {
+    const auto bitmap = GetBuffer<uint8_t>(array, 0);
+    return !bitmap || (bitmap[row / 8] >> (row % 8)) & 1;
+}
+
+}
+
+TEST(ArrowCase, ExportBlock) {
+    auto ids = std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2, 3});
+
+    auto date_time = std::make_shared<ColumnDateTime>("UTC");
+    auto date32 = std::make_shared<ColumnDate32>();
+    auto date_time64 = std::make_shared<ColumnDateTime64>(2);
+    auto decimal = std::make_shared<ColumnDecimal>(10, 2);
+    for (int64_t i = 0; i < 3; ++i) {
+        date_time->Append(1700000000 + i);
+        date32->Append(-86400 * i);
+        date_time64->Append(12345 + i);
+        decimal->Append(-150 + i);
+    }
+
+    auto nullable = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnInt32>(std::vector<int32_t>{10, 0, 30}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0}));
+
+    auto array = std::make_shared<ColumnArrayT<ColumnUInt8>>();
+    array->Append(std::vector<uint8_t>{1, 2});
+    array->Append(std::vector<uint8_t>{});
+    array->Append(std::vector<uint8_t>{3});
+
+    Block block;
+    block.AppendColumn("id", ids);
+    block.AppendColumn("name", std::make_shared<ColumnString>(std::vector<std::string>{"a", "", "long value"}));
+    block.AppendColumn("code", std::make_shared<ColumnFixedString>(3, std::vector<std::string>{"abc", "de", "fgh"}));
+    block.AppendColumn("nullable", nullable);
+    block.AppendColumn("array", array);
+    block.AppendColumn("date_time", date_time);
+    block.AppendColumn("date32", date32);
+    block.AppendColumn("date_time64", date_time64);
+    block.AppendColumn("decimal", decimal);
+
+    ArrowSchema schema;
+    ArrowArray batch;
+    ExportToArrow(block, &schema, &batch);
+
+    EXPECT_STREQ("+s", schema.format);
+    ASSERT_EQ(9, schema.n_children);
+    ASSERT_EQ(9, batch.n_children);
+    EXPECT_EQ(3, batch.length);
+
+    // Numbers are shared with the column.
+    EXPECT_STREQ("id", schema.children[0]->name);
+    EXPECT_STREQ("L", schema.children[0]->format);
+    EXPECT_EQ(ids->GetData().data(), batch.children[0]->buffers[1]);
+
+    // Strings too, as large binary.
+    const ArrowArray& name = *batch.children[1];
+    EXPECT_STREQ("Z", schema.children[1]->format);
+    ASSERT_EQ(3, name.n_buffers);
+    EXPECT_EQ(block[1]->As<ColumnString>()->GetChars().data(), name.buffers[2]);
+    EXPECT_EQ(11, GetBuffer<int64_t>(name, 1)[3]);
+    EXPECT_EQ("long value", std::string(GetBuffer<char>(name, 2) + GetBuffer<int64_t>(name, 1)[2], 10));
+
+    EXPECT_STREQ("w:3", schema.children[2]->format);
+    EXPECT_EQ(0, std::memcmp("abcde\0fgh", GetBuffer<char>(*batch.children[2], 1), 9));
+
+    const ArrowArray& nulls = *batch.children[3];
+    EXPECT_STREQ("i", schema.children[3]->format);
+    EXPECT_EQ(ARROW_FLAG_NULLABLE, schema.children[3]->flags);
+    EXPECT_EQ(1, nulls.null_count);
+    EXPECT_TRUE(IsValid(nulls, 0));
+    EXPECT_FALSE(IsValid(nulls, 1));
+    EXPECT_EQ(30, GetBuffer<int32_t>(nulls, 1)[2]);
+
+    const ArrowArray& list = *batch.children[4];
+    EXPECT_STREQ("+l", schema.children[4]->format);
+    EXPECT_STREQ("C", schema.children[4]->children[0]->format);
+    EXPECT_EQ(3, list.children[0]->length);
+    EXPECT_EQ((std::vector<int32_t>{0, 2, 2, 3}), std::vector<int32_t>(GetBuffer<int32_t>(list, 1), GetBuffer<int32_t>(list, 1) + 4));
+
+    EXPECT_STREQ("tss:UTC", schema.children[5]->format);
+    EXPECT_EQ(1700000002, GetBuffer<int64_t>(*batch.children[5], 1)[2]);
+
+    EXPECT_STREQ("tdD", schema.children[6]->format);
+    EXPECT_EQ(-2, GetBuffer<int32_t>(*batch.children[6], 1)[2]);
+
+    // Hundredths of a second are exported as milliseconds.
+    EXPECT_STREQ("tsm:", schema.children[7]->format);
+    EXPECT_EQ(123460, GetBuffer<int64_t>(*batch.children[7], 1)[1]);
+
+    EXPECT_STREQ("d:10,2", schema.children[8]->format);
+    int64_t low, high;
+    std::memcpy(&low, GetBuffer<uint8_t>(*batch.children[8], 1), sizeof(low));
+    std::memcpy(&high, GetBuffer<uint8_t>(*batch.children[8], 1) + 8, sizeof(high));
+    EXPECT_EQ(-150, low);
+    EXPECT_EQ(-1, high);
+
+    batch.release(&batch);
+    schema.release(&schema);
+    EXPECT_EQ(nullptr, batch.release);
+    EXPECT_EQ(nullptr, schema.release);
+}
+
+TEST(ArrowCase, ExportLowCardinalityAndTuple) {
+    auto lc = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnString>(std::vector<std::string>{"foo", "", "foo", "bar"}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0, 0})));
+
+    ArrowSchema schema;
+    ArrowArray array;
+    ExportToArrow(lc, "lc", &schema, &array);
+
+    EXPECT_STREQ("C", schema.format);
+    ASSERT_NE(nullptr, schema.dictionary);
+    EXPECT_STREQ("Z", schema.dictionary->format);
+    EXPECT_EQ(1, array.null_count);
+    EXPECT_FALSE(IsValid(array, 1));
+
+    const auto indices = GetBuffer<uint8_t>(array, 1);
+    const ArrowArray& dictionary = *array.dictionary;
+    const auto offsets = GetBuffer<int64_t>(dictionary, 1);
+    const auto chars = GetBuffer<char>(dictionary, 2);
+    EXPECT_EQ(indices[0], indices[2]);
+    EXPECT_EQ("foo", std::string(chars + offsets[indices[0]], offsets[indices[0] + 1] - offsets[indices[0]]));
+    EXPECT_EQ("bar", std::string(chars + offsets[indices[3]], offsets[indices[3] + 1] - offsets[indices[3]]));
+
+    array.release(&array);
+    schema.release(&schema);
+
+    auto tuple = std::make_shared<ColumnTuple>(std::vector<ColumnRef>{
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{1, 2}),
+        std::make_shared<ColumnString>(std::vector<std::string>{"a", "b"})});
+    ExportToArrow(tuple, "tuple", &schema, &array, ArrowExportOptions{true});
+
+    EXPECT_STREQ("+s", schema.format);
+    ASSERT_EQ(2, schema.n_children);
+    EXPECT_STREQ("1", schema.children[0]->name);
+    EXPECT_STREQ("U", schema.children[1]->format);
+
+    // A child may be moved out of the parent and released separately.
+    ArrowSchema child_schema = *schema.children[0];
+    ArrowArray child = *array.children[0];
+    schema.children[0]->release = nullptr;
+    array.children[0]->release = nullptr;
+    array.release(&array);
+    schema.release(&schema);
+    tuple.reset();
+
+    EXPECT_EQ(2, GetBuffer<uint8_t>(child, 1)[1]);
+    child.release(&child);
+    child_schema.release(&child_schema);
+}
+
+TEST(ArrowCase, ExportUnsupported) {
+    ArrowSchema schema{};
+    ArrowArray array{};
+    EXPECT_THROW(ExportToArrow(std::make_shared<ColumnUUID>(), "uuid", &schema, &array), UnimplementedError);
+    EXPECT_EQ(nullptr, schema.release);
+    EXPECT_EQ(nullptr, array.release);
+}
+
+TEST(ArrowCase, ImportExported) {
+    auto nullable = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnInt32>(std::vector<int32_t>{10, 0, 30}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0}));
+    auto array = std::make_shared<ColumnArrayT<ColumnString>>();
+    array->Append(std::vector<std::string>{"a", "b"});
+    array->Append(std::vector<std::string>{});
+    array->Append(std::vector<std::string>{"c"});
+    auto lc = std::make_shared<ColumnLowCardinality>(std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnString>(std::vector<std::string>{"x", "", "x"}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0})));
+
+    Block block;
+    block.AppendColumn("id", std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 2, 3}));
+    block.AppendColumn("nullable", nullable);
+    block.AppendColumn("array", array);
+    block.AppendColumn("lc", lc);
+    block.AppendColumn("date_time", std::make_shared<ColumnDateTime>("UTC", std::vector<uint32_t>{1, 2, 3}));
+    auto decimal = std::make_shared<ColumnDecimal64>(12, 2);
+    decimal->AppendMany(std::vector<int64_t>{-150, 0, 123456789012});
+    block.AppendColumn("decimal", decimal);
+
+    ArrowSchema schema;
+    ArrowArray batch;
+    ExportToArrow(block, &schema, &batch);
+    const auto imported = ImportBlockFromArrow(&schema, &batch);
+    EXPECT_EQ(nullptr, schema.release);
+    EXPECT_EQ(nullptr, batch.release);
+
+    ASSERT_EQ(6u, imported.GetColumnCount());
+    ASSERT_EQ(3u, imported.GetRowCount());
+    for (size_t i = 0; i < imported.GetColumnCount(); ++i) {
+        EXPECT_EQ(block.GetColumnName(i), imported.GetColumnName(i));
+        EXPECT_EQ(block[i]->Type()->GetName(), imported[i]->Type()->GetName());
+    }
+
+    EXPECT_EQ(3u, imported[0]->As<ColumnUInt64>()->At(2));
+    EXPECT_TRUE(imported[1]->As<ColumnNullable>()->IsNull(1));
+    EXPECT_EQ(30, imported[1]->As<ColumnNullable>()->Nested()->As<ColumnInt32>()->At(2));
+    EXPECT_EQ(2u, imported[2]->As<ColumnArray>()->GetAsColumnTyped<ColumnString>(0)->Size());
+    EXPECT_EQ("c", imported[2]->As<ColumnArray>()->GetAsColumnTyped<ColumnString>(2)->At(0));
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(lc->GetItem(i).type, imported[3]->GetItem(i).type) << i;
+        EXPECT_EQ(lc->GetItem(i).data, imported[3]->GetItem(i).data) << i;
+    }
+    EXPECT_EQ(3, imported[4]->As<ColumnDateTime>()->At(2));
+    ASSERT_NE(nullptr, imported[5]->As<ColumnDecimal64>());
+    EXPECT_EQ(decimal->GetData(), imported[5]->As<ColumnDecimal64>()->GetData());
+}
+
+TEST(ArrowCase, ImportSliced) {
+    // Booleans with nulls, the array starts at the row 3 of buffers.
+    const uint8_t validity[] = {0b11110111, 0b00000001};
+    const uint8_t values[] = {0b10101000, 0b00000001};
+    const void* buffers[] = {validity, values};
+
+    ArrowSchema schema{};
+    schema.format = "b";
+    schema.name = "flag";
+    schema.release = [](ArrowSchema* s) { s->release = nullptr; };
+
+    ArrowArray array{};
+    array.length = 6;
+    array.null_count = -1;
+    array.offset = 3;
+    array.n_buffers = 2;
+    array.buffers = buffers;
+    array.release = [](ArrowArray* a) { a->release = nullptr; };
+
+    const auto column = ImportColumnFromArrow(&schema, &array);
+    EXPECT_EQ(nullptr, schema.release);
+    EXPECT_EQ(nullptr, array.release);
+
+    const auto nullable = column->As<ColumnNullable>();
+    ASSERT_NE(nullptr, nullable);
+    ASSERT_EQ(6u, nullable->Size());
+    const auto flags = nullable->Nested()->As<ColumnUInt8>();
+    EXPECT_TRUE(nullable->IsNull(0));
+    EXPECT_FALSE(nullable->IsNull(1));
+    EXPECT_EQ((std::vector<uint8_t>{1, 0, 1, 0, 1, 1}), flags->GetData());
+
+    // Dictionary of integers is decoded.
+    const int64_t dictionary_values[] = {100, 200};
+    const void* dictionary_buffers[] = {nullptr, dictionary_values};
+    const int8_t indices[] = {1, 0, 1};
+    const void* index_buffers[] = {nullptr, indices};
+
+    ArrowSchema dictionary_schema{};
+    dictionary_schema.format = "l";
+    dictionary_schema.release = schema.release;
+    ArrowArray dictionary_array{};
+    dictionary_array.length = 2;
+    dictionary_array.n_buffers = 2;
+    dictionary_array.buffers = dictionary_buffers;
+    dictionary_array.release = array.release;
+
+    schema.format = "c";
+    schema.dictionary = &dictionary_schema;
+    schema.release = [](ArrowSchema* s) { s->release = nullptr; };
+    array = ArrowArray{};
+    array.length = 3;
+    array.n_buffers = 2;
+    array.buffers = index_buffers;
+    array.dictionary = &dictionary_array;
+    array.release = [](ArrowArray* a) { a->release = nullptr; };
+
+    const auto decoded = ImportColumnFromArrow(&schema, &array);
+    EXPECT_EQ((std::vector<int64_t>{200, 100, 200}), decoded->As<ColumnInt64>()->GetData());
+}
+
+TEST(ArrowCase, ImportInvalid) {
+    ArrowSchema schema{};
+    schema.format = "+w:2";
+    schema.release = [](ArrowSchema* s) { s->release = nullptr; };
+    ArrowArray array{};
+    array.release = [](ArrowArray* a) { a->release = nullptr; };
+
+    EXPECT_THROW(ImportColumnFromArrow(&schema, &array), UnimplementedError);
+    // Structures are released anyway.
+    EXPECT_EQ(nullptr, schema.release);
+    EXPECT_EQ(nullptr, array.release);
+
+    // Widths of fixed-size binary arrays must be positive numbers.
+    for (const char* format : {"w:0", "w:", "w:x", "w:3x", "w:99999999999999999999999"}) {
+        schema.format = format;
+        schema.release = [](ArrowSchema* s) { s->release = nullptr; };
+        array.release = [](ArrowArray* a) { a->release = nullptr; };
+        EXPECT_THROW(ImportColumnFromArrow(&schema, &array), ValidationError) << format;
+    }
+}
+
+TEST(ArrowCase, ImportTimestampsBeyondDateTime) {
+    const int64_t values[] = {0, -1, 5000000000};
+    const void* buffers[] = {nullptr, values};
+
+    ArrowSchema schema{};
+    schema.format = "tss:UTC";
+    schema.release = [](ArrowSchema* s) { s->release = nullptr; };
+    ArrowArray array{};
+    array.length = 3;
+    array.n_buffers = 2;
+    array.buffers = buffers;
+    array.release = [](ArrowArray* a) { a->release = nullptr; };
+
+    // Values aren't truncated to 32 bits, the column is DateTime64(0) instead.
+    const auto column = ImportColumnFromArrow(&schema, &array);
+    const auto date_time64 = column->As<ColumnDateTime64>();
+    ASSERT_NE(nullptr, date_time64);
+    EXPECT_EQ(0u, date_time64->GetPrecision());
+    EXPECT_EQ("UTC", date_time64->Timezone());
+    EXPECT_EQ(0, date_time64->At(0));
+    EXPECT_EQ(-1, date_time64->At(1));
+    EXPECT_EQ(5000000000, date_time64->At(2));
+}
@@ -83,3 +83,52 @@ TEST(BlockTest, Iterators) {
     ASSERT_NE(block.cbegin(), block.cend());
 }
 
+
+TEST(BlockTest, SortBy) {
+    auto block = MakeBlock({
+        {"id", std::make_shared<ColumnUInt64>(std::vector<uint64_t>{0, 1, 2, 3, 4, 5, 6})},
+        {"group", std::make_shared<ColumnString>(std::vector<std::string>{"b", "a", "b", "", "a", "b", "ab"})},
+        {"value", std::make_shared<ColumnInt32>(std::vector<int32_t>{1000, -1, -70000, 5, -1, 3, 0})},
+    });
+
+    block.SortBy({"value"});
+    // Rows with equal keys keep their order.
+    EXPECT_EQ((std::vector<uint64_t>{2, 1, 4, 6, 5, 3, 0}), block[0]->As<ColumnUInt64>()->GetData());
+    EXPECT_EQ(7u, block.GetRowCount());
+
+    block.SortBy({"group", "value"});
+    EXPECT_EQ((std::vector<uint64_t>{3, 1, 4, 6, 2, 5, 0}), block[0]->As<ColumnUInt64>()->GetData());
+    EXPECT_EQ("b", block[1]->As<ColumnString>()->At(4));
+    EXPECT_EQ(-70000, block[2]->As<ColumnInt32>()->At(4));
+
+    EXPECT_THROW(block.SortBy({"missing"}), ValidationError);
+}
+
+TEST(BlockTest, SortBy_DatesAndWideIntegers) {
+    auto date_time = std::make_shared<ColumnDateTime>();
+    auto date32 = std::make_shared<ColumnDate32>();
+    for (auto t : {std::time_t(86400 * 3), std::time_t(86400), std::time_t(86400 * 3), std::time_t(0)}) {
+        date_time->Append(t);
+        date32->Append(-t);
+    }
+
+    auto block = MakeBlock({
+        {"id", std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 2, 3})},
+        {"date_time", date_time},
+        {"date32", date32},
+        {"big", std::make_shared<ColumnInt64>(std::vector<int64_t>{int64_t(1) << 40, -(int64_t(1) << 40), 7, 0})},
+    });
+
+    block.SortBy({"date_time", "big"});
+    EXPECT_EQ((std::vector<uint8_t>{3, 1, 2, 0}), block[0]->As<ColumnUInt8>()->GetData());
+
+    block.SortBy({"date32"});
+    EXPECT_EQ((std::vector<uint8_t>{2, 0, 1, 3}), block[0]->As<ColumnUInt8>()->GetData());
+
+    block.SortBy({"big"});
+    EXPECT_EQ((std::vector<uint8_t>{1, 3, 2, 0}), block[0]->As<ColumnUInt8>()->GetData());
+    EXPECT_EQ(-(int64_t(1) << 40), block[3]->As<ColumnInt64>()->At(0));
+
+    auto floats = MakeBlock({{"f", std::make_shared<ColumnFloat64>(std::vector<double>{1.5})}});
+    EXPECT_THROW(floats.SortBy({"f"}), ValidationError);
+}
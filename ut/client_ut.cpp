@@ -1,9 +1,16 @@
 #include <clickhouse/client.h>
+#include <clickhouse/native_format.h>
+#include <clickhouse/protocol.h>
+#include <clickhouse/base/compressed.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/socket.h>
+#include <clickhouse/base/wire_format.h>
 
 #include "readonly_client_test.h"
 #include "connection_failed_client_test.h"
 #include "utils.h"
 #include "roundtrip_column.h"
+#include "tcp_server.h"
 
 #include <gtest/gtest.h>
 
@@ -429,6 +436,190 @@ TEST_P(ClientCase, Numbers) {
     EXPECT_EQ(100000U, num);
 }
 
+TEST_P(ClientCase, SelectAll) {
+    // Small max_block_size makes server split result into many blocks.
+    const Block block = client_->SelectAll(
+            "SELECT number, toString(number), [number, number] FROM system.numbers LIMIT 100000 SETTINGS max_block_size = 1000");
+
+    ASSERT_EQ(3u, block.GetColumnCount());
+    ASSERT_EQ(100000u, block.GetRowCount());
+
+    auto numbers = block[0]->As<ColumnUInt64>();
+    auto strings = block[1]->As<ColumnString>();
+    auto arrays = block[2]->As<ColumnArray>();
+    ASSERT_NE(nullptr, numbers);
+    ASSERT_NE(nullptr, strings);
+    ASSERT_NE(nullptr, arrays);
+
+    for (size_t i = 0; i < block.GetRowCount(); ++i) {
+        EXPECT_EQ(i, numbers->At(i));
+        EXPECT_EQ(std::to_string(i), strings->At(i));
+        EXPECT_EQ(2u, arrays->GetAsColumn(i)->Size());
+    }
+}
+
+TEST_P(ClientCase, SelectAll_Empty) {
+    const Block block = client_->SelectAll("SELECT number, toString(number) FROM system.numbers LIMIT 0");
+
+    EXPECT_EQ(2u, block.GetColumnCount());
+    EXPECT_EQ(0u, block.GetRowCount());
+}
+
+TEST_P(ClientCase, QueryTimeout) {
+    size_t rows = 0;
+    Query query("SELECT sleepEachRow(0.01), number FROM system.numbers LIMIT 1000 SETTINGS max_block_size = 10");
+    query.SetTimeout(std::chrono::milliseconds(200))
+        .OnData([&rows](const Block& block) { rows += block.GetRowCount(); });
+
+    EXPECT_THROW(client_->Execute(query), TimeoutError);
+    EXPECT_LT(rows, 1000u);
+
+    // Connection is still usable.
+    EXPECT_EQ(1u, client_->SelectAll("SELECT 1").GetRowCount());
+}
+
+TEST_P(ClientCase, QueryTimeout_FastAbort) {
+    Query query("SELECT number FROM system.numbers");
+    query.SetTimeout(std::chrono::milliseconds(200))
+        .SetCancelPolicy(QueryCancelPolicy::FastAbort);
+
+    EXPECT_THROW(client_->Execute(query), TimeoutError);
+
+    // Connection has been reset and is usable.
+    EXPECT_EQ(1u, client_->SelectAll("SELECT 1").GetRowCount());
+}
+
+TEST_P(ClientCase, QueryTimeout_NotExpired) {
+    Query query("SELECT number FROM system.numbers LIMIT 10");
+    query.SetTimeout(std::chrono::seconds(60));
+
+    EXPECT_NO_THROW(client_->Execute(query));
+}
+
+TEST_P(ClientCase, ExternalTables) {
+    auto ids = std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1, 5, 42, 1000});
+    auto names = std::make_shared<ColumnString>(std::vector<std::string>{"one", "five", "forty two", "thousand"});
+
+    Block ids_block;
+    ids_block.AppendColumn("id", ids);
+
+    Block names_block;
+    names_block.AppendColumn("id", ids);
+    names_block.AppendColumn("name", names);
+
+    Query query("SELECT number, name FROM system.numbers"
+                " ANY INNER JOIN names ON number = names.id"
+                " WHERE number IN ids AND number < 100 ORDER BY number LIMIT 100");
+    query.AddExternalTable("ids", ids_block)
+        .AddExternalTable("names", names_block);
+
+    std::vector<std::pair<uint64_t, std::string>> rows;
+    query.OnData([&rows](const Block& block) {
+        for (size_t i = 0; i < block.GetRowCount(); ++i) {
+            rows.emplace_back(block[0]->As<ColumnUInt64>()->At(i), block[1]->As<ColumnString>()->At(i));
+        }
+    });
+    client_->Execute(query);
+
+    const std::vector<std::pair<uint64_t, std::string>> expected{{1, "one"}, {5, "five"}, {42, "forty two"}};
+    EXPECT_EQ(expected, rows);
+}
+
+TEST_P(ClientCase, ExternalTables_NoName) {
+    Block block;
+    block.AppendColumn("id", std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1}));
+
+    EXPECT_THROW(client_->Execute(Query("SELECT 1").AddExternalTable("", block)), ValidationError);
+
+    // Nothing has been sent, connection is still usable.
+    EXPECT_EQ(1u, client_->SelectAll("SELECT 1").GetRowCount());
+}
+
+TEST_P(ClientCase, SparseColumns) {
+    const std::string table_name = "test_clickhouse_cpp_sparse";
+    client_->Execute("DROP TABLE IF EXISTS " + table_name);
+    client_->Execute("CREATE TABLE " + table_name + " (id UInt64, value UInt64, str String) "
+                     "ENGINE = MergeTree ORDER BY id SETTINGS ratio_of_defaults_for_sparse_serialization = 0.5");
+    client_->Execute("INSERT INTO " + table_name + " SELECT number, if(number % 100 = 0, number, 0), if(number % 100 = 0, toString(number), '') "
+                     "FROM system.numbers LIMIT 1000");
+
+    const auto check = [](const Block& block) {
+        ASSERT_EQ(1000u, block.GetRowCount());
+        auto values = block[1]->As<ColumnUInt64>();
+        auto strings = block[2]->As<ColumnString>();
+        ASSERT_NE(nullptr, values);
+        ASSERT_NE(nullptr, strings);
+        for (size_t i = 0; i < block.GetRowCount(); ++i) {
+            EXPECT_EQ(i % 100 == 0 ? i : 0u, values->At(i));
+            EXPECT_EQ(i % 100 == 0 ? std::to_string(i) : "", strings->At(i));
+        }
+    };
+    const std::string query = "SELECT id, value, str FROM " + table_name + " ORDER BY id";
+
+    // Sparse columns are converted to ordinary ones by default.
+    check(client_->SelectAll(query));
+
+    Client sparse_client(ClientOptions(GetParam()).SetKeepSparseColumns(true));
+    const Block sparse_block = sparse_client.SelectAll(query);
+    Block block;
+    for (Block::Iterator bi(sparse_block); bi.IsValid(); bi.Next()) {
+        // Server may decide not to use sparse serialization, so this is not checked.
+        if (auto sparse = bi.Column()->As<ColumnSparse>()) {
+            block.AppendColumn(bi.Name(), sparse->Dense());
+        } else {
+            block.AppendColumn(bi.Name(), bi.Column());
+        }
+    }
+    check(block);
+
+    client_->Execute("DROP TABLE " + table_name);
+}
+
+TEST_P(ClientCase, SelectRaw) {
+    const std::string query = "SELECT number, toString(number) FROM system.numbers LIMIT 10000 SETTINGS max_block_size = 1000";
+
+    if (GetParam().compression_method == CompressionMethod::None) {
+        EXPECT_THROW(client_->SelectRaw(query, [](const RawBlock&) {}), ValidationError);
+        return;
+    }
+
+    size_t rows = 0;
+    client_->SelectRaw(query, [&rows](const RawBlock& raw) {
+        EXPECT_EQ(2u, raw.columns);
+        ASSERT_FALSE(raw.frames.headers.empty());
+
+        // Frames decompress to the block in Native format.
+        ArrayInput input(raw.frames.data.data(), raw.frames.data.size());
+        CompressedInput compressed(&input);
+        uint64_t num;
+        uint64_t columns = 0;
+        uint64_t block_rows = 0;
+        // Block info: field 1 (is_overflows), field 2 (bucket_num), terminating 0.
+        uint8_t is_overflows;
+        int32_t bucket_num;
+        ASSERT_TRUE(WireFormat::ReadUInt64(compressed, &num));
+        ASSERT_TRUE(WireFormat::ReadFixed(compressed, &is_overflows));
+        ASSERT_TRUE(WireFormat::ReadUInt64(compressed, &num));
+        ASSERT_TRUE(WireFormat::ReadFixed(compressed, &bucket_num));
+        ASSERT_TRUE(WireFormat::ReadUInt64(compressed, &num));
+        ASSERT_TRUE(WireFormat::ReadUInt64(compressed, &columns));
+        ASSERT_TRUE(WireFormat::ReadUInt64(compressed, &block_rows));
+        EXPECT_EQ(raw.columns, columns);
+        EXPECT_EQ(raw.rows, block_rows);
+
+        // Skip the rest, since only the header is checked.
+        const void* ptr;
+        while (compressed.Next(&ptr, 4096)) {}
+
+        rows += raw.rows;
+    });
+
+    EXPECT_EQ(10000u, rows);
+
+    // Connection is in a proper state after raw select.
+    EXPECT_EQ(1u, client_->SelectAll("SELECT 1").GetRowCount());
+}
+
 TEST_P(ClientCase, SimpleAggregateFunction) {
     const auto & server_info = client_->GetServerInfo();
     if (versionNumber(server_info) < versionNumber(19, 9)) {
@@ -1317,6 +1508,157 @@ const auto QUERIES = std::vector<std::string>{
 };
 }
 
+#if !defined(_win_)
+
+TEST(InsertEncodingCase, LowCardinality) {
+    const int port = 19982;
+    LocalTcpServer server(port);
+    server.start();
+
+    std::string received;
+    std::thread fake_server([&server, &received] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        Buffer response;
+        {
+            BufferOutput output(&response);
+            WriteServerHello(output, 54465);
+
+            // Structure of the table: block info, 3 columns without rows and without custom serialization.
+            WireFormat::WriteUInt64(output, ServerCodes::Data);
+            WireFormat::WriteString(output, "");
+            WireFormat::WriteUInt64(output, 1);
+            WireFormat::WriteFixed<uint8_t>(output, 0);
+            WireFormat::WriteUInt64(output, 2);
+            WireFormat::WriteFixed<int32_t>(output, -1);
+            WireFormat::WriteUInt64(output, 0);
+            WireFormat::WriteUInt64(output, 3);
+            WireFormat::WriteUInt64(output, 0);
+            for (const auto& [name, type] : std::vector<std::pair<std::string, std::string>>{
+                    {"name", "LowCardinality(String)"},
+                    {"tag", "LowCardinality(Nullable(String))"},
+                    {"plain", "String"}}) {
+                WireFormat::WriteString(output, name);
+                WireFormat::WriteString(output, type);
+                WireFormat::WriteFixed<uint8_t>(output, 0);
+            }
+            WireFormat::WriteUInt64(output, ServerCodes::EndOfStream);
+            output.Flush();
+        }
+        received = RespondAndReceive(fd, response);
+    });
+
+    const std::vector<std::string> names{"a", "b", "a", "a"};
+    const std::vector<std::string> tags{"x", "", "x", "y"};
+    const std::vector<uint8_t> tag_nulls{0, 1, 0, 0};
+
+    Block block;
+    block.AppendColumn("name", std::make_shared<ColumnString>(names));
+    auto tag = std::make_shared<ColumnNullable>(std::make_shared<ColumnString>(tags), std::make_shared<ColumnUInt8>(tag_nulls));
+    block.AppendColumn("tag", tag);
+    block.AppendColumn("plain", std::make_shared<ColumnString>(names));
+
+    {
+        Client client(ClientOptions()
+            .SetHost("localhost")
+            .SetPort(port)
+            .SetEncodeLowCardinalityOnInsert(true));
+
+        client.Insert("test_table", block);
+    }
+    fake_server.join();
+
+    const auto serialized = [](const std::string& name, Column& column) {
+        Buffer buffer;
+        BufferOutput output(&buffer);
+        WireFormat::WriteString(output, name);
+        WireFormat::WriteString(output, column.Type()->GetName());
+        WireFormat::WriteFixed<uint8_t>(output, 0);
+        column.Save(&output);
+        return std::string(buffer.begin(), buffer.end());
+    };
+
+    // String columns are sent as LowCardinality ones, when the table has such columns.
+    ColumnLowCardinalityT<ColumnString> expected_name;
+    expected_name.AppendMany(names);
+    EXPECT_NE(std::string::npos, received.find(serialized("name", expected_name)));
+
+    ColumnLowCardinality expected_tag(std::make_shared<ColumnNullable>(std::make_shared<ColumnString>(), std::make_shared<ColumnUInt8>()));
+    expected_tag.AppendFrom(*tag);
+    EXPECT_NE(std::string::npos, received.find(serialized("tag", expected_tag)));
+
+    ColumnString expected_plain(names);
+    EXPECT_NE(std::string::npos, received.find(serialized("plain", expected_plain)));
+}
+
+TEST(QueryTimeoutCase, SelectRawAfterDeadline) {
+    const int port = 19985;
+    LocalTcpServer server(port);
+    server.start();
+
+    const auto data_packet = [](uint64_t value) {
+        Block block;
+        block.AppendColumn("x", std::make_shared<ColumnUInt64>(std::vector<uint64_t>{value}));
+        NativeFormatSettings settings;
+        settings.revision = 54465;
+
+        Buffer buffer;
+        BufferOutput output(&buffer);
+        WireFormat::WriteUInt64(output, ServerCodes::Data);
+        WireFormat::WriteString(output, "");
+        {
+            CompressedOutput compressed(&output);
+            WriteNativeBlock(compressed, settings, block);
+            compressed.Flush();
+        }
+        output.Flush();
+        return buffer;
+    };
+
+    std::thread fake_server([&server, &data_packet] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        Buffer response;
+        {
+            BufferOutput output(&response);
+            WriteServerHello(output, 54465);
+            output.Flush();
+        }
+        const auto first = data_packet(1);
+        response.insert(response.end(), first.begin(), first.end());
+        SocketOutput(fd).Write(response.data(), response.size());
+
+        // The second block comes after the deadline, then the query ends.
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        auto second = data_packet(2);
+        second.push_back(ServerCodes::EndOfStream);
+        RespondAndReceive(fd, second);
+    });
+
+    size_t blocks = 0;
+    {
+        Client client(ClientOptions()
+            .SetHost("localhost")
+            .SetPort(port)
+            .SetCompressionMethod(CompressionMethod::LZ4));
+
+        EXPECT_THROW(
+            client.SelectRaw(Query("SELECT x").SetTimeout(std::chrono::milliseconds(100)), [&blocks](const RawBlock& raw) {
+                EXPECT_EQ(1u, raw.rows);
+                ++blocks;
+            }),
+            TimeoutError);
+    }
+    fake_server.join();
+
+    // Only the block received before the deadline is delivered.
+    EXPECT_EQ(1u, blocks);
+}
+
+#endif
+
 INSTANTIATE_TEST_SUITE_P(ClientLocalReadonly, ReadonlyClientTest,
     ::testing::Values(ReadonlyClientTest::ParamType{
         ClientOptions(LocalHostEndpoint)
@@ -69,6 +69,69 @@ TEST(ColumnArray, Append) {
     ASSERT_EQ(col->As<ColumnUInt64>()->At(1), 3u);
 }
 
+TEST(ColumnArray, Append_Bulk) {
+    const std::vector<std::vector<uint64_t>> values = {
+        {1u, 2u, 3u},
+        {},
+        {4u},
+        {5u, 6u}
+    };
+
+    auto array = CreateArray<ColumnUInt64>(values);
+    array->Append(CreateArray<ColumnUInt64>(values));
+    // Column may be appended to itself.
+    array->Append(array);
+
+    ASSERT_EQ(values.size() * 4, array->Size());
+    EXPECT_EQ(array->Offsets().back(), array->Nested()->Size());
+    for (size_t i = 0; i < array->Size(); ++i) {
+        EXPECT_TRUE(CompareRecursive(values[i % values.size()], *array->GetAsColumnTyped<ColumnUInt64>(i))) << " at pos: " << i;
+    }
+
+    // Only values of the arrays are appended from the slice of the nested column.
+    auto array_2d = Create2DArray<ColumnUInt64>(std::vector<std::vector<std::vector<uint64_t>>>{{{1u}, {2u, 3u}}, {}});
+    array_2d->Append(array_2d->Slice(0, 1));
+    ASSERT_EQ(3u, array_2d->Size());
+    auto last = array_2d->GetAsColumnTyped<ColumnArray>(2);
+    ASSERT_EQ(2u, last->Size());
+    EXPECT_TRUE(CompareRecursive(std::vector<uint64_t>{2u, 3u}, *last->GetAsColumnTyped<ColumnUInt64>(1)));
+
+    // Arrays of other type are ignored.
+    array->Append(CreateArray<ColumnUInt32>(std::vector<std::vector<uint32_t>>{{1u}}));
+    EXPECT_EQ(values.size() * 4, array->Size());
+}
+
+TEST(ColumnArray, FromOffsetsAndLengths) {
+    const std::vector<std::vector<uint64_t>> values = {
+        {1u, 2u, 3u},
+        {},
+        {4u},
+    };
+
+    ColumnArray array(std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1u, 2u, 3u, 4u}), std::vector<uint64_t>{0, 3, 3, 4});
+    ASSERT_EQ(values.size(), array.Size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_TRUE(CompareRecursive(values[i], *array.GetAsColumnTyped<ColumnUInt64>(i)));
+    }
+
+    auto from_lengths = ColumnArray::FromLengths(std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1u, 2u, 3u, 4u}), {3, 0, 1});
+    EXPECT_EQ(array.Offsets(), from_lengths->Offsets());
+
+    ColumnArrayT<ColumnUInt64> typed(std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1u, 2u, 3u, 4u}), std::vector<uint64_t>{0, 3, 3, 4});
+    EXPECT_EQ(3u, typed.At(0).size());
+    EXPECT_EQ(4u, typed.At(2)[0]);
+
+    // Empty array.
+    EXPECT_EQ(0u, ColumnArray(std::make_shared<ColumnUInt64>(), std::vector<uint64_t>{0}).Size());
+
+    auto values_column = std::make_shared<ColumnUInt64>(std::vector<uint64_t>{1u, 2u});
+    EXPECT_THROW(ColumnArray(values_column, std::vector<uint64_t>{}), ValidationError);
+    EXPECT_THROW(ColumnArray(values_column, std::vector<uint64_t>{1, 2}), ValidationError);
+    EXPECT_THROW(ColumnArray(values_column, std::vector<uint64_t>{0, 2, 1}), ValidationError);
+    EXPECT_THROW(ColumnArray(values_column, std::vector<uint64_t>{0, 1}), ValidationError);
+    EXPECT_THROW(ColumnArray::FromLengths(values_column, {1, 2}), ValidationError);
+}
+
 TEST(ColumnArray, ArrayOfDecimal) {
     auto column = std::make_shared<clickhouse::ColumnDecimal>(18, 10);
     auto array = std::make_shared<clickhouse::ColumnArray>(column->CloneEmpty());
@@ -1,24 +1,28 @@
 #include <clickhouse/columns/array.h>
 #include <clickhouse/columns/tuple.h>
 #include <clickhouse/columns/date.h>
+#include <clickhouse/columns/decimal.h>
 #include <clickhouse/columns/enum.h>
 #include <clickhouse/columns/factory.h>
 #include <clickhouse/columns/lowcardinality.h>
 #include <clickhouse/columns/nullable.h>
 #include <clickhouse/columns/numeric.h>
 #include <clickhouse/columns/map.h>
+#include <clickhouse/columns/sparse.h>
 #include <clickhouse/columns/string.h>
 #include <clickhouse/columns/uuid.h>
 #include <clickhouse/columns/ip4.h>
 #include <clickhouse/columns/ip6.h>
 #include <clickhouse/base/input.h>
 #include <clickhouse/base/output.h>
+#include <clickhouse/base/wire_format.h>
 #include <clickhouse/base/socket.h> // for ipv4-ipv6 platform-specific stuff
 
 #include <gtest/gtest.h>
 #include "utils.h"
 #include "value_generators.h"
 
+#include <optional>
 #include <string_view>
 #include <sstream>
 #include <vector>
@@ -126,6 +130,105 @@ TEST(ColumnsCase, StringAppend) {
     ASSERT_EQ(col->At(2), "11");
 }
 
+TEST(ColumnsCase, StringCharsAndOffsets) {
+    auto col = std::make_shared<ColumnString>(std::vector<char>{'a', 'b', 'c', 'd'}, std::vector<uint64_t>{0, 1, 1, 4});
+
+    ASSERT_EQ(col->Size(), 3u);
+    ASSERT_EQ(col->At(0), "a");
+    ASSERT_EQ(col->At(1), "");
+    ASSERT_EQ(col->At(2), "bcd");
+    EXPECT_THROW(col->At(3), std::out_of_range);
+
+    // Column may be appended to itself.
+    col->Append(col);
+    ASSERT_EQ(col->Size(), 6u);
+    ASSERT_EQ(col->At(5), "bcd");
+    EXPECT_EQ((std::vector<uint64_t>{0, 1, 1, 4, 5, 5, 8}), col->GetOffsets());
+    EXPECT_EQ(std::string("abcdabcd"), std::string(col->GetChars().begin(), col->GetChars().end()));
+
+    auto slice = col->Slice(2, 3)->As<ColumnString>();
+    EXPECT_EQ((std::vector<uint64_t>{0, 3, 4, 4}), slice->GetOffsets());
+    EXPECT_EQ(slice->At(0), "bcd");
+
+    col->Clear();
+    ASSERT_EQ(col->Size(), 0u);
+    EXPECT_EQ((std::vector<uint64_t>{0}), col->GetOffsets());
+
+    EXPECT_THROW(ColumnString({'a'}, {1, 1}), ValidationError);
+    EXPECT_THROW(ColumnString({'a'}, {0, 1, 0}), ValidationError);
+    EXPECT_THROW(ColumnString({'a'}, {0, 2}), ValidationError);
+}
+
+TEST(ColumnsCase, StringLoadAcrossWindows) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 100; ++i) {
+        // Lengths of more than 127 bytes take 2 bytes of varint.
+        values.push_back(std::string(i % 10 == 0 ? 200 + i : i % 7, static_cast<char>('a' + i % 26)));
+    }
+
+    Buffer buffer;
+    {
+        BufferOutput output(&buffer);
+        ColumnString(values).SaveBody(&output);
+        output.Flush();
+    }
+
+    // Values cross boundaries of small windows of the input at all positions.
+    for (size_t window : {1, 2, 3, 7, 64, 4096}) {
+        BufferedInput input(std::make_unique<ArrayInput>(buffer.data(), buffer.size()), window);
+        ColumnString col;
+        ASSERT_TRUE(col.LoadBody(&input, values.size())) << window;
+        ASSERT_EQ(values.size(), col.Size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQ(values[i], col[i]) << window << " " << i;
+        }
+    }
+
+    // Input ends in the middle of a value.
+    ArrayInput input(buffer.data(), buffer.size() - 1);
+    ColumnString col;
+    EXPECT_FALSE(col.LoadBody(&input, values.size()));
+}
+
+TEST(ColumnsCase, StringSaveInChunks) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 1000; ++i) {
+        values.push_back(std::string(i % 100 == 0 ? 100000 + i : i % 13, static_cast<char>('a' + i % 26)));
+    }
+    ColumnString col(values);
+
+    Buffer expected;
+    {
+        BufferOutput output(&expected);
+        for (const auto& value : values) {
+            WireFormat::WriteString(output, value);
+        }
+    }
+
+    // Windows of ZeroCopyOutput.
+    for (size_t window : {1, 5, 64, 8192}) {
+        Buffer buffer;
+        {
+            BufferedOutput output(std::make_unique<BufferOutput>(&buffer), window);
+            col.SaveBody(&output);
+            output.Flush();
+        }
+        EXPECT_EQ(expected, buffer) << window;
+    }
+
+    // Staging chunks for other streams.
+    struct StringOutput : public OutputStream {
+        std::string data;
+
+        size_t DoWrite(const void* buf, size_t len) override {
+            data.append(static_cast<const char*>(buf), len);
+            return len;
+        }
+    } output;
+    col.SaveBody(&output);
+    EXPECT_EQ(std::string(expected.begin(), expected.end()), output.data);
+}
+
 TEST(ColumnsCase, TupleAppend){
     auto tuple1 = std::make_shared<ColumnTuple>(std::vector<ColumnRef>({
                                 std::make_shared<ColumnUInt64>(),
@@ -632,6 +735,100 @@ TEST(ColumnsCase, ColumnDecimal128_from_string_overflow) {
 #endif
 }
 
+TEST(ColumnsCase, ColumnDecimalT) {
+    ColumnDecimal64 col(12, 2);
+    col.Append(int64_t{-12345});
+    col.AppendMany(std::vector<int64_t>{1, 2, 3});
+    col.Append(Int128(4));
+    col.Append("5.5");
+
+    EXPECT_EQ("Decimal(12,2)", col.Type()->GetName());
+    EXPECT_EQ((std::vector<int64_t>{-12345, 1, 2, 3, 4, 550}), col.GetData());
+    EXPECT_EQ(-12345, col.At(0));
+    EXPECT_EQ(550, col[5]);
+    EXPECT_EQ(Int128(550), static_cast<const ColumnDecimal&>(col).At(5));
+
+    auto slice = col.Slice(1, 2)->As<ColumnDecimal64>();
+    ASSERT_NE(nullptr, slice);
+    EXPECT_EQ((std::vector<int64_t>{1, 2}), slice->GetData());
+    EXPECT_EQ(col.Type()->GetName(), slice->Type()->GetName());
+
+    auto empty = col.CloneEmpty()->As<ColumnDecimal64>();
+    ASSERT_NE(nullptr, empty);
+    empty->Swap(*slice);
+    EXPECT_EQ((std::vector<int64_t>{1, 2}), empty->GetData());
+    EXPECT_EQ(0u, slice->Size());
+
+    // Storage is exchanged with a plain column of the same type, not with one of other storage.
+    ColumnDecimal plain(12, 2);
+    plain.Append(Int128(7));
+    plain.Swap(*empty);
+    EXPECT_EQ(2u, plain.Size());
+    EXPECT_EQ((std::vector<int64_t>{7}), empty->GetData());
+    empty->Swap(plain);
+    EXPECT_EQ((std::vector<int64_t>{1, 2}), empty->GetData());
+    ColumnDecimal wide(20, 2);
+    EXPECT_THROW(wide.Swap(*empty), ValidationError);
+    EXPECT_THROW(empty->Swap(wide), ValidationError);
+
+    EXPECT_EQ("Decimal(9,3)", ColumnDecimal32(3).Type()->GetName());
+    EXPECT_EQ("Decimal(38,3)", ColumnDecimal128(3).Type()->GetName());
+    EXPECT_THROW(ColumnDecimal32(10, 2), ValidationError);
+    EXPECT_THROW(ColumnDecimal128(18, 2), ValidationError);
+
+    EXPECT_NE(nullptr, CreateColumnByType("Decimal(9, 2)")->As<ColumnDecimal32>());
+    EXPECT_NE(nullptr, CreateColumnByType("Decimal(18, 2)")->As<ColumnDecimal64>());
+    EXPECT_NE(nullptr, CreateColumnByType("Decimal(38, 2)")->As<ColumnDecimal128>());
+    EXPECT_NE(nullptr, CreateColumnByType("Decimal64(4)")->As<ColumnDecimal64>());
+}
+
+TEST(ColumnsCase, ColumnDecimal_AppendFromText) {
+    const std::vector<std::pair<std::string_view, Int128>> values{
+        {"", 0},
+        {"0", 0},
+        {"-1", -100},
+        {"1.5", 150},
+        {"-0.05", -5},
+        {"12.345", 1234},
+        {".7", 70},
+        {"3.", 300},
+        {"123456789012345678", Int128(123456789012345678) * 100},
+        {"12345678901234567890.12", absl::MakeInt128(0, 12345678901234567890ull) * 100 + 12},
+        {"-1701411834604692317316873037158841057.27", std::numeric_limits<Int128>::min() + 1},
+    };
+
+    ColumnDecimal128 col(38, 2);
+    std::vector<std::string_view> text;
+    for (const auto& [value, _] : values) {
+        text.push_back(value);
+    }
+    col.AppendFromText(text);
+
+    ASSERT_EQ(values.size(), col.Size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(values[i].second, col.At(i)) << " at pos: " << i;
+
+        // Same as values parsed one by one.
+        ColumnDecimal single(38, 2);
+        single.Append(std::string(values[i].first));
+        EXPECT_EQ(values[i].second, single.At(0)) << " at pos: " << i;
+    }
+
+    // Narrow storage.
+    ColumnDecimal32 narrow(9, 4);
+    narrow.AppendFromText({"1.2345", "-99999.9999"});
+    EXPECT_EQ((std::vector<int32_t>{12345, -999999999}), narrow.GetData());
+
+    // Nothing is appended, if any value is invalid.
+    EXPECT_THROW(col.AppendFromText({"1", "1-"}), ValidationError);
+    EXPECT_THROW(col.AppendFromText({"1", "12345678a.5"}), ValidationError);
+    EXPECT_THROW(col.AppendFromText({"1", "1.2.3"}), ValidationError);
+    EXPECT_THROW(col.AppendFromText({"1", "1.234x"}), ValidationError);
+    EXPECT_THROW(col.AppendFromText({"1", "+1"}), ValidationError);
+    EXPECT_THROW(col.AppendFromText({"1", "3402823669209384634633746074317682114.56"}), AssertionError);
+    EXPECT_EQ(values.size(), col.Size());
+}
+
 TEST(ColumnsCase, ColumnLowCardinalityString_Append_and_Read) {
     const size_t items_count = 11;
     ColumnLowCardinalityT<ColumnString> col;
@@ -789,6 +986,289 @@ TEST(ColumnsCase, ColumnLowCardinalityString_WithEmptyString_3) {
     }
 }
 
+TEST(ColumnsCase, ColumnLowCardinalityString_ManyUniqueItems) {
+    // Hash table of unique items grows many times.
+    ColumnLowCardinalityT<ColumnString> col;
+    for (size_t i = 0; i < 30000; ++i) {
+        col.Append(std::to_string(i % 10000));
+    }
+
+    ASSERT_EQ(10000u + 1, col.GetDictionarySize());
+    for (size_t i = 0; i < col.Size(); ++i) {
+        ASSERT_EQ(std::to_string(i % 10000), col.At(i)) << " at pos: " << i;
+    }
+    // Index column is widened, as dictionary grows.
+    ASSERT_NE(nullptr, col.Indices()->As<ColumnUInt16>());
+    EXPECT_EQ(col.Indices()->As<ColumnUInt16>()->At(1), col.Indices()->As<ColumnUInt16>()->At(10001));
+
+    // Same after load.
+    Buffer buffer;
+    {
+        BufferOutput output(&buffer);
+        col.Save(&output);
+    }
+    ColumnLowCardinalityT<ColumnString> loaded;
+    ArrayInput input(buffer.data(), buffer.size());
+    ASSERT_TRUE(loaded.Load(&input, col.Size()));
+    loaded.Append("123");
+    loaded.Append("new");
+    EXPECT_EQ(10000u + 2, loaded.GetDictionarySize());
+    EXPECT_EQ("new", loaded.At(loaded.Size() - 1));
+
+    // And after permutation.
+    auto permuted = loaded.Permute({1, 0})->As<ColumnLowCardinality>();
+    permuted->Append(col.Slice(5, 2));
+    EXPECT_EQ(10000u + 2, permuted->GetDictionarySize());
+    EXPECT_EQ(std::string_view("6"), permuted->GetItem(3).data);
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityString_IndexWidth) {
+    ColumnLowCardinalityT<ColumnString> col;
+    ASSERT_NE(nullptr, col.Indices()->As<ColumnUInt8>());
+
+    // Dictionary of 256 items, including the default one, is addressed by UInt8.
+    for (size_t i = 1; i < 256; ++i) {
+        col.Append(std::to_string(i));
+    }
+    ASSERT_NE(nullptr, col.Indices()->As<ColumnUInt8>());
+
+    col.Append("256");
+    ASSERT_NE(nullptr, col.Indices()->As<ColumnUInt16>());
+    for (size_t i = 0; i < col.Size(); ++i) {
+        ASSERT_EQ(std::to_string(i + 1), col.At(i));
+    }
+
+    col.Clear();
+    EXPECT_NE(nullptr, col.Indices()->As<ColumnUInt8>());
+
+    // Loaded index column, which is wider than needed, is narrowed when saved.
+    const auto data =
+        "\x02\x02\x00\x00\x00\x00\x00\x00"           // UInt32 index, HasAdditionalKeysBit
+        "\x02\x00\x00\x00\x00\x00\x00\x00\x00\x01\x61" // 2 keys: "" and "a"
+        "\x02\x00\x00\x00\x00\x00\x00\x00"           // 2 rows
+        "\x01\x00\x00\x00\x00\x00\x00\x00"sv;
+    ArrayInput input(data.data(), data.size());
+    ASSERT_TRUE(col.LoadBody(&input, 2));
+    ASSERT_NE(nullptr, col.Indices()->As<ColumnUInt32>());
+
+    Buffer buffer;
+    BufferOutput output(&buffer);
+    col.SaveBody(&output);
+    EXPECT_EQ((std::vector<uint8_t>{0x00, 0x02, 0, 0, 0, 0, 0, 0}), std::vector<uint8_t>(buffer.begin(), buffer.begin() + 8));
+    EXPECT_EQ((std::vector<uint8_t>{0x01, 0x00}), std::vector<uint8_t>(buffer.end() - 2, buffer.end()));
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityNullableString_LoadGlobalDictionary) {
+    // Keys of nullable dictionary start with the null item and the default one.
+    const auto data =
+        "\x00\x07\x00\x00\x00\x00\x00\x00"              // UInt8 index, NeedGlobalDictionaryBit, HasAdditionalKeysBit, NeedUpdateDictionary
+        "\x03\x00\x00\x00\x00\x00\x00\x00\x00\x00\x01\x61" // global dictionary: null, "" and "a"
+        "\x01\x00\x00\x00\x00\x00\x00\x00\x01\x62"        // additional keys: "b"
+        "\x04\x00\x00\x00\x00\x00\x00\x00\x00\x01\x02\x03"  // 4 rows: NULL, "", "a", "b"
+        "\x00\x01\x00\x00\x00\x00\x00\x00"              // UInt8 index, NeedGlobalDictionaryBit
+        "\x03\x00\x00\x00\x00\x00\x00\x00\x01\x00\x02"sv;   // 3 rows: "", NULL, "a"
+    const std::vector<std::optional<std::string>> expected{std::nullopt, "", "a", "b", "", std::nullopt, "a"};
+
+    ColumnLowCardinality col(std::make_shared<ColumnNullable>(std::make_shared<ColumnString>(), std::make_shared<ColumnUInt8>()));
+    ArrayInput input(data.data(), data.size());
+    ASSERT_TRUE(col.LoadBody(&input, expected.size()));
+    ASSERT_EQ(expected.size(), col.Size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const auto item = col.GetItem(i);
+        if (expected[i]) {
+            EXPECT_EQ(Type::String, item.type) << " at pos: " << i;
+            EXPECT_EQ(*expected[i], item.data) << " at pos: " << i;
+        } else {
+            EXPECT_EQ(Type::Void, item.type) << " at pos: " << i;
+        }
+    }
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityString_LoadGlobalDictionary) {
+    const auto data =
+        "\x00\x07\x00\x00\x00\x00\x00\x00"           // UInt8 index, NeedGlobalDictionaryBit, HasAdditionalKeysBit, NeedUpdateDictionary
+        "\x02\x00\x00\x00\x00\x00\x00\x00\x00\x01\x61" // global dictionary: "" and "a"
+        "\x01\x00\x00\x00\x00\x00\x00\x00\x01\x62"     // additional keys: "b"
+        "\x02\x00\x00\x00\x00\x00\x00\x00\x01\x02"     // 2 rows: "a", "b"
+        "\x00\x01\x00\x00\x00\x00\x00\x00"           // UInt8 index, NeedGlobalDictionaryBit
+        "\x03\x00\x00\x00\x00\x00\x00\x00\x00\x01\x00" // 3 rows: "", "a", ""
+        "\x00\x05\x00\x00\x00\x00\x00\x00"           // UInt8 index, NeedGlobalDictionaryBit, NeedUpdateDictionary
+        "\x02\x00\x00\x00\x00\x00\x00\x00\x00\x01\x63" // new global dictionary: "" and "c"
+        "\x01\x00\x00\x00\x00\x00\x00\x00\x01"         // 1 row: "c"
+        "\x00\x03\x00\x00\x00\x00\x00\x00"           // UInt8 index, NeedGlobalDictionaryBit, HasAdditionalKeysBit
+        "\x01\x00\x00\x00\x00\x00\x00\x00\x01\x64"     // additional keys: "d"
+        "\x02\x00\x00\x00\x00\x00\x00\x00\x02\x01"sv;  // 2 rows: "d", "c"
+    const std::vector<std::string> expected{"a", "b", "", "a", "", "c", "d", "c"};
+
+    ColumnLowCardinalityT<ColumnString> col;
+    ArrayInput input(data.data(), data.size());
+    ASSERT_TRUE(col.LoadBody(&input, expected.size()));
+    ASSERT_EQ(expected.size(), col.Size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i], col.At(i)) << " at pos: " << i;
+    }
+
+    // Unique items are merged, so "a" and "c" are appended as existing ones.
+    const auto dictionary_size = col.GetDictionarySize();
+    col.Append("a");
+    col.Append("c");
+    EXPECT_EQ(dictionary_size, col.GetDictionarySize());
+
+    // Rows of granules must not exceed rows of the column.
+    ColumnLowCardinalityT<ColumnString> short_col;
+    ArrayInput short_input(data.data(), data.size());
+    EXPECT_FALSE(short_col.LoadBody(&short_input, 4));
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityString_AppendFrom) {
+    std::vector<std::string> values;
+    for (size_t i = 0; i < 3000; ++i) {
+        values.push_back(i % 7 == 0 ? std::string() : std::to_string(i % 500));
+    }
+
+    ColumnLowCardinalityT<ColumnString> expected;
+    ColumnLowCardinalityT<ColumnString> col;
+    for (const auto & value : values) {
+        expected.Append(value);
+    }
+    col.Append("1");
+    col.AppendFrom(ColumnString(values));
+
+    ASSERT_EQ(values.size() + 1, col.Size());
+    EXPECT_EQ(expected.GetDictionarySize(), col.GetDictionarySize());
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values[i], col.At(i + 1)) << " at pos: " << i;
+    }
+
+    // AppendMany goes through AppendFrom.
+    col.AppendMany(std::vector<std::string>{"new", "1", ""});
+    EXPECT_EQ(expected.GetDictionarySize() + 1, col.GetDictionarySize());
+    EXPECT_EQ("new", col.At(values.size() + 1));
+    EXPECT_EQ("", col.At(values.size() + 3));
+
+    EXPECT_THROW(col.AppendFrom(ColumnFixedString(3)), ValidationError);
+    EXPECT_THROW(col.AppendFrom(ColumnUInt8()), ValidationError);
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityNullable_AppendFrom) {
+    auto nested = std::make_shared<ColumnFixedString>(2, std::vector<std::string>{"ab", "", "ab", "cd", ""});
+    auto nulls = std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0, 0, 0});
+    ColumnNullable values(nested, nulls);
+
+    ColumnLowCardinality col(std::make_shared<ColumnNullable>(std::make_shared<ColumnFixedString>(2), std::make_shared<ColumnUInt8>()));
+    col.AppendFrom(values);
+    // Non-nullable values may be appended too.
+    col.AppendFrom(*nested);
+
+    ASSERT_EQ(10u, col.Size());
+    // Null item, default item, "ab" and "cd".
+    EXPECT_EQ(4u, col.GetDictionarySize());
+    EXPECT_EQ(Type::Void, col.GetItem(1).type);
+    EXPECT_EQ(std::string_view("\0\0", 2), col.GetItem(4).data);
+    EXPECT_EQ(std::string_view("\0\0", 2), col.GetItem(6).data);
+    EXPECT_EQ("cd", col.GetItem(8).data);
+
+    ColumnLowCardinalityT<ColumnString> not_nullable;
+    EXPECT_THROW(not_nullable.AppendFrom(ColumnNullable(std::make_shared<ColumnString>(), std::make_shared<ColumnUInt8>())), ValidationError);
+}
+
+TEST(ColumnsCase, ColumnLowCardinalityFixedString_Padding) {
+    // Values, which differ only by trailing zeroes, are the same FixedString value.
+    ColumnLowCardinalityT<ColumnFixedString> col(3);
+    col.Append("ab");
+    col.Append(std::string_view("ab\0", 3));
+    col.Append("");
+    col.Append(std::string_view("\0\0\0", 3));
+
+    EXPECT_EQ(2u, col.GetDictionarySize());
+    EXPECT_EQ(std::string_view("ab\0", 3), col.At(1));
+    EXPECT_EQ(std::string_view("\0\0\0", 3), col.At(3));
+}
+
+
+TEST(ColumnsCase, ColumnSparse_Dense) {
+    auto values = std::make_shared<ColumnString>(std::vector<std::string>{"foo", "bar", "baz"});
+    ColumnSparse col(values, {1, 2, 5}, 7);
+
+    ASSERT_EQ(7u, col.Size());
+    EXPECT_EQ(Type::String, col.GetType().GetCode());
+
+    auto dense = col.Dense()->As<ColumnString>();
+    ASSERT_NE(nullptr, dense);
+    const std::vector<std::string> expected{"", "foo", "bar", "", "", "baz", ""};
+    ASSERT_EQ(expected.size(), dense->Size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i], dense->At(i)) << " at pos: " << i;
+        EXPECT_EQ(expected[i], col.GetItem(i).get<std::string_view>()) << " at pos: " << i;
+    }
+
+    // Dense representation is cached until column is modified.
+    EXPECT_EQ(col.Dense(), col.Dense());
+    col.AppendDefaults(2);
+    EXPECT_EQ(9u, col.Dense()->Size());
+}
+
+TEST(ColumnsCase, ColumnSparse_SaveAndLoad) {
+    ColumnSparse col(std::make_shared<ColumnUInt8>(std::vector<uint8_t>{10, 20}), {1, 4}, 6);
+
+    char buffer[256] = {'\0'};
+    size_t size = 0;
+    {
+        ArrayOutput output(buffer, sizeof(buffer));
+        col.Save(&output);
+        size = sizeof(buffer) - output.Avail();
+    }
+
+    // Number of defaults before each value, then number of trailing defaults with END_OF_GRANULE_FLAG (1 << 62), then values.
+    const std::string_view expected = "\x01\x02\x81\x80\x80\x80\x80\x80\x80\x80\x40\x0a\x14"sv;
+    EXPECT_EQ(expected, std::string_view(buffer, size));
+
+    ColumnSparse loaded(std::make_shared<ColumnUInt8>());
+    ArrayInput input(buffer, size);
+    ASSERT_TRUE(loaded.Load(&input, col.Size()));
+
+    EXPECT_EQ(6u, loaded.Size());
+    EXPECT_EQ(col.Offsets(), loaded.Offsets());
+    EXPECT_EQ(2u, loaded.Values()->Size());
+
+    auto dense = loaded.Dense()->As<ColumnUInt8>();
+    const std::vector<uint8_t> expected_values{0, 10, 0, 0, 20, 0};
+    for (size_t i = 0; i < expected_values.size(); ++i) {
+        EXPECT_EQ(expected_values[i], dense->At(i)) << " at pos: " << i;
+    }
+}
+
+TEST(ColumnsCase, ColumnSparse_Load_SizeMismatch) {
+    ColumnSparse col(std::make_shared<ColumnUInt8>(std::vector<uint8_t>{10}), {1}, 3);
+
+    char buffer[256] = {'\0'};
+    ArrayOutput output(buffer, sizeof(buffer));
+    col.Save(&output);
+
+    ColumnSparse loaded(std::make_shared<ColumnUInt8>());
+    ArrayInput input(buffer, sizeof(buffer) - output.Avail());
+    EXPECT_FALSE(loaded.Load(&input, 5));
+}
+
+TEST(ColumnsCase, ColumnSparse_SliceAndAppend) {
+    ColumnSparse col(std::make_shared<ColumnUInt32>(std::vector<uint32_t>{1, 2, 3}), {0, 3, 8}, 10);
+
+    auto slice = col.Slice(2, 7)->As<ColumnSparse>();
+    ASSERT_NE(nullptr, slice);
+    EXPECT_EQ(7u, slice->Size());
+    EXPECT_EQ(std::vector<uint64_t>({1, 6}), slice->Offsets());
+
+    col.Append(slice);
+    EXPECT_EQ(17u, col.Size());
+    EXPECT_EQ(std::vector<uint64_t>({0, 3, 8, 11, 16}), col.Offsets());
+
+    col.Append(std::make_shared<ColumnUInt32>(std::vector<uint32_t>{0, 7}));
+    EXPECT_EQ(19u, col.Size());
+    EXPECT_EQ(7u, col.Dense()->As<ColumnUInt32>()->At(18));
+
+    EXPECT_THROW(col.Append(std::make_shared<ColumnString>()), ValidationError);
+    EXPECT_THROW(ColumnSparse(std::make_shared<ColumnUInt32>(std::vector<uint32_t>{1}), {5}, 3), ValidationError);
+}
 
 TEST(ColumnsCase, ColumnTupleT) {
     using TestTuple = ColumnTupleT<ColumnUInt64, ColumnString, ColumnFixedString>;
@@ -888,3 +1368,108 @@ TEST(ColumnsCase, ColumnMapT_Wrap) {
     EXPECT_EQ("123", map_view.At(1));
     EXPECT_EQ("abc", map_view.At(2));
 }
+
+TEST(ColumnsCase, NullablePermuteAndFilter) {
+    auto col = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnUInt32>(std::vector<uint32_t>{1, 0, 3, 0}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{0, 1, 0, 1}));
+
+    auto permuted = col->Permute({3, 2, 2})->AsStrict<ColumnNullable>();
+    ASSERT_EQ(3u, permuted->Size());
+    EXPECT_TRUE(permuted->IsNull(0));
+    EXPECT_FALSE(permuted->IsNull(1));
+    EXPECT_EQ(3u, permuted->Nested()->As<ColumnUInt32>()->At(2));
+
+    auto filtered = col->Filter({1, 1, 0, 0})->AsStrict<ColumnNullable>();
+    ASSERT_EQ(2u, filtered->Size());
+    EXPECT_FALSE(filtered->IsNull(0));
+    EXPECT_TRUE(filtered->IsNull(1));
+    EXPECT_EQ(1u, filtered->Nested()->As<ColumnUInt32>()->At(0));
+}
+
+TEST(ColumnsCase, EnumDateTimeDecimalPermute) {
+    auto enum_col = std::make_shared<ColumnEnum8>(Type::CreateEnum8({{"Hi", 1}, {"Hello", 2}}));
+    enum_col->Append("Hi");
+    enum_col->Append("Hello");
+    auto permuted_enum = enum_col->Permute({1, 1, 0})->AsStrict<ColumnEnum8>();
+    EXPECT_TRUE(enum_col->Type()->IsEqual(permuted_enum->Type()));
+    ASSERT_EQ(3u, permuted_enum->Size());
+    EXPECT_EQ("Hello", permuted_enum->NameAt(1));
+    EXPECT_EQ("Hi", permuted_enum->NameAt(2));
+    EXPECT_THROW(enum_col->Permute({2}), ValidationError);
+
+    // Timezone is kept.
+    auto date_time = std::make_shared<ColumnDateTime>("Europe/Moscow", std::vector<uint32_t>{1, 2, 3});
+    auto permuted_date_time = date_time->Permute({2, 0})->AsStrict<ColumnDateTime>();
+    EXPECT_EQ("DateTime('Europe/Moscow')", permuted_date_time->Type()->GetName());
+    EXPECT_EQ((std::vector<uint32_t>{3, 1}), permuted_date_time->GetRawData());
+
+    auto decimal = std::make_shared<ColumnDecimal64>(12, 2);
+    decimal->AppendMany(std::vector<int64_t>{10, 20, 30});
+    auto permuted_decimal = decimal->Permute({2, 0, 2})->AsStrict<ColumnDecimal64>();
+    EXPECT_EQ("Decimal(12,2)", permuted_decimal->Type()->GetName());
+    EXPECT_EQ((std::vector<int64_t>{30, 10, 30}), permuted_decimal->GetData());
+}
+
+TEST(ColumnsCase, ArrayPermuteAndScatter) {
+    auto col = std::make_shared<ColumnArrayT<ColumnUInt64>>();
+    col->Append(std::vector<uint64_t>{1, 2});
+    col->Append(std::vector<uint64_t>{});
+    col->Append(std::vector<uint64_t>{3, 4, 5});
+
+    auto permuted = col->Permute({2, 1, 0, 2})->AsStrict<ColumnArrayT<ColumnUInt64>>();
+    ASSERT_EQ(4u, permuted->Size());
+    EXPECT_EQ(3u, permuted->At(0).size());
+    EXPECT_EQ(0u, permuted->At(1).size());
+    EXPECT_EQ(2u, permuted->At(2)[1]);
+    EXPECT_EQ(5u, permuted->At(3)[2]);
+
+    const auto parts = col->Scatter({1, 0, 1}, 2);
+    ASSERT_EQ(2u, parts.size());
+    auto second = parts[1]->AsStrict<ColumnArrayT<ColumnUInt64>>();
+    ASSERT_EQ(2u, second->Size());
+    EXPECT_EQ(1u, second->At(0)[0]);
+    EXPECT_EQ(4u, second->At(1)[1]);
+    EXPECT_EQ(1u, parts[0]->Size());
+}
+
+TEST(ColumnsCase, TupleAndMapPermute) {
+    using TestTuple = ColumnTupleT<ColumnUInt64, ColumnString>;
+    auto tuple = std::make_shared<TestTuple>(std::make_tuple(std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>()));
+    tuple->Append(std::make_tuple(1, "a"));
+    tuple->Append(std::make_tuple(2, "b"));
+
+    auto permuted_tuple = tuple->Permute({1, 0})->AsStrict<TestTuple>();
+    EXPECT_EQ(std::make_tuple(uint64_t(2), std::string_view("b")), permuted_tuple->At(0));
+    EXPECT_EQ(std::make_tuple(uint64_t(1), std::string_view("a")), permuted_tuple->At(1));
+
+    using TestMap = ColumnMapT<ColumnUInt64, ColumnString>;
+    auto map = std::make_shared<TestMap>(std::make_shared<ColumnUInt64>(), std::make_shared<ColumnString>());
+    map->Append(std::map<uint64_t, std::string>{{1, "a"}});
+    map->Append(std::map<uint64_t, std::string>{{2, "b"}, {3, "c"}});
+
+    auto permuted_map = map->Filter({0, 1})->AsStrict<TestMap>();
+    ASSERT_EQ(1u, permuted_map->Size());
+    EXPECT_EQ("c", permuted_map->At(0).At(3));
+}
+
+TEST(ColumnsCase, LowCardinalityScatter) {
+    auto col = std::make_shared<ColumnLowCardinalityT<ColumnString>>();
+    col->AppendMany(std::vector<std::string>{"a", "b", "a", "c"});
+
+    const auto parts = col->Scatter({0, 1, 1, 0}, 2);
+    ASSERT_EQ(2u, parts.size());
+
+    auto first = parts[0]->AsStrict<ColumnLowCardinality>();
+    ASSERT_EQ(2u, first->Size());
+    EXPECT_EQ("a", first->GetItem(0).get<std::string_view>());
+    EXPECT_EQ("c", first->GetItem(1).get<std::string_view>());
+    auto second = parts[1]->AsStrict<ColumnLowCardinality>();
+    EXPECT_EQ("b", second->GetItem(0).get<std::string_view>());
+    EXPECT_EQ("a", second->GetItem(1).get<std::string_view>());
+
+    // Appending to a permuted column reuses the dictionary.
+    second->Append(col);
+    EXPECT_EQ(6u, second->Size());
+    EXPECT_EQ(col->GetDictionarySize(), second->GetDictionarySize());
+}
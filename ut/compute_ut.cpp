@@ -0,0 +1,127 @@
+#include <clickhouse/columns/compute.h>
+#include <clickhouse/columns/string.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace clickhouse;
+
+namespace {
+
+/// Values of every sign, count of them is not a multiple of the width of a vector.
+template <typename T>
+std::vector<T> MakeValues(size_t size) {
+    std::vector<T> values;
+    for (size_t i = 0; i < size; ++i) {
+        values.push_back(static_cast<T>((i * 7919) % 201) - static_cast<T>(std::is_signed_v<T> ? 100 : 0));
+    }
+    return values;
+}
+
+std::shared_ptr<ColumnNullable> MakeNullable(ColumnRef nested) {
+    auto nulls = std::make_shared<ColumnUInt8>();
+    for (size_t i = 0; i < nested->Size(); ++i) {
+        nulls->Append(i % 3 == 0);
+    }
+    return std::make_shared<ColumnNullable>(nested, nulls);
+}
+
+}
+
+template <typename T>
+class ComputeTest : public testing::Test {};
+
+using NumericTypes = testing::Types<int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t, float, double>;
+TYPED_TEST_SUITE(ComputeTest, NumericTypes);
+
+TYPED_TEST(ComputeTest, Aggregates) {
+    using T = TypeParam;
+
+    const auto values = MakeValues<T>(1003);
+    const auto column = std::make_shared<ColumnVector<T>>(values);
+    const auto nullable = MakeNullable(column);
+
+    SumType<T> sum = 0;
+    SumType<T> non_null_sum = 0;
+    std::optional<T> non_null_min;
+    std::optional<T> non_null_max;
+    for (size_t i = 0; i < values.size(); ++i) {
+        sum += values[i];
+        if (!nullable->IsNull(i)) {
+            non_null_sum += values[i];
+            non_null_min = std::min(non_null_min.value_or(values[i]), values[i]);
+            non_null_max = std::max(non_null_max.value_or(values[i]), values[i]);
+        }
+    }
+
+    EXPECT_EQ(sum, Sum(*column));
+    EXPECT_EQ(*std::min_element(values.begin(), values.end()), Min(*column));
+    EXPECT_EQ(*std::max_element(values.begin(), values.end()), Max(*column));
+
+    EXPECT_EQ(non_null_sum, Sum<T>(*nullable));
+    EXPECT_EQ(non_null_min, Min<T>(*nullable));
+    EXPECT_EQ(non_null_max, Max<T>(*nullable));
+    EXPECT_EQ(668u, CountNonNull(*nullable));
+
+    // No values.
+    const ColumnVector<T> empty;
+    EXPECT_EQ(SumType<T>(0), Sum(empty));
+    EXPECT_EQ(std::nullopt, Min(empty));
+    EXPECT_EQ(std::nullopt, Max(empty));
+
+    const auto all_nulls = std::make_shared<ColumnNullable>(
+        std::make_shared<ColumnVector<T>>(std::vector<T>{1, 2}),
+        std::make_shared<ColumnUInt8>(std::vector<uint8_t>{1, 1}));
+    EXPECT_EQ(std::nullopt, Min<T>(*all_nulls));
+    EXPECT_EQ(SumType<T>(0), Sum<T>(*all_nulls));
+    EXPECT_EQ(0u, CountNonNull(*all_nulls));
+}
+
+TYPED_TEST(ComputeTest, Compare) {
+    using T = TypeParam;
+
+    const auto values = MakeValues<T>(37);
+    const auto column = std::make_shared<ColumnVector<T>>(values);
+    const auto nullable = MakeNullable(column);
+    const T scalar = values[5];
+
+    const auto less = Compare(*column, CompareOp::Less, scalar);
+    const auto equals = Compare(*column, CompareOp::Equals, scalar);
+    const auto greater_or_equals = Compare<T>(*nullable, CompareOp::GreaterOrEquals, scalar);
+    ASSERT_EQ(values.size(), less.size());
+
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_EQ(values[i] < scalar, less[i]) << i;
+        EXPECT_EQ(values[i] == scalar, equals[i]) << i;
+        EXPECT_EQ(!nullable->IsNull(i) && values[i] >= scalar, greater_or_equals[i]) << i;
+    }
+
+    // Mask selects rows of the column.
+    const auto filtered = column->Filter(less)->template As<ColumnVector<T>>();
+    for (size_t i = 0; i < filtered->Size(); ++i) {
+        EXPECT_LT(filtered->At(i), scalar);
+    }
+}
+
+TEST(ComputeCase, Overflow) {
+    const ColumnInt64 column(std::vector<int64_t>{std::numeric_limits<int64_t>::max(), 1});
+    EXPECT_EQ(std::numeric_limits<int64_t>::min(), Sum(column));
+
+    const ColumnUInt8 bytes(std::vector<uint8_t>(1000, 255));
+    EXPECT_EQ(255000u, Sum(bytes));
+}
+
+TEST(ComputeCase, NestedTypeMismatch) {
+    const auto nullable = MakeNullable(std::make_shared<ColumnString>(std::vector<std::string>{"a"}));
+    EXPECT_THROW(Sum<int32_t>(*nullable), ValidationError);
+    EXPECT_EQ(0u, CountNonNull(*nullable));
+}
+
+TEST(ComputeCase, FloatExtremes) {
+    const ColumnFloat64 column(std::vector<double>{1.5, -std::numeric_limits<double>::infinity(), 2.0});
+    EXPECT_EQ(-std::numeric_limits<double>::infinity(), Min(column));
+    EXPECT_EQ(2.0, Max(column));
+}
@@ -0,0 +1,129 @@
+#include <clickhouse/insert_router.h>
+
+#include <cityhash/city.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace clickhouse;
+
+namespace {
+
+std::vector<Shard> MakeShards(std::vector<uint32_t> weights) {
+    std::vector<Shard> shards;
+    for (auto weight : weights) {
+        Shard shard;
+        shard.client_options.SetHost("localhost").SetPort(19984).SetRetryTimeout(std::chrono::seconds(0));
+        shard.table_name = "test_table";
+        shard.weight = weight;
+        shards.push_back(shard);
+    }
+    return shards;
+}
+
+template <typename ColumnType, typename T>
+Block MakeBlock(std::vector<T> keys) {
+    std::vector<uint64_t> rows;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        rows.push_back(i);
+    }
+
+    Block block;
+    block.AppendColumn("row", std::make_shared<ColumnUInt64>(std::move(rows)));
+    block.AppendColumn("key", std::make_shared<ColumnType>(std::move(keys)));
+    return block;
+}
+
+/// Returns shard of every row of the block passed to InsertRouter::Scatter().
+std::vector<size_t> GetShards(const std::vector<Block>& blocks, size_t rows) {
+    std::vector<size_t> shards(rows, blocks.size());
+    for (size_t s = 0; s < blocks.size(); ++s) {
+        EXPECT_EQ(2u, blocks[s].GetColumnCount());
+        const auto row_column = blocks[s][0]->As<ColumnUInt64>();
+        for (size_t i = 0; i < row_column->Size(); ++i) {
+            shards.at(row_column->At(i)) = s;
+        }
+    }
+    return shards;
+}
+
+}
+
+TEST(InsertRouterCase, Scatter_Identity) {
+    InsertRouter router(MakeShards({1, 2}), "key", ShardingFunction::Identity);
+
+    const auto blocks = router.Scatter(MakeBlock<ColumnUInt64>(std::vector<uint64_t>{0, 1, 2, 3, 4, 5, 6}));
+    ASSERT_EQ(2u, blocks.size());
+
+    // Shard 0 receives one row of every three, shard 1 - two of them.
+    EXPECT_EQ((std::vector<size_t>{0, 1, 1, 0, 1, 1, 0}), GetShards(blocks, 7));
+    EXPECT_EQ(3u, blocks[0].GetRowCount());
+    EXPECT_EQ(4u, blocks[1].GetRowCount());
+    EXPECT_EQ(3u, blocks[0][1]->As<ColumnUInt64>()->At(1));
+
+    // Value of a signed key is taken as unsigned of the same width.
+    const auto negative = router.Scatter(MakeBlock<ColumnInt32>(std::vector<int32_t>{-1}));
+    EXPECT_EQ((std::vector<size_t>{uint32_t(-1) % 3 == 0 ? 0u : 1u}), GetShards(negative, 1));
+}
+
+TEST(InsertRouterCase, Scatter_IntegerHashes) {
+    const std::vector<int32_t> keys{-5, -1, 0, 1, 2, 3, 1000, 123456};
+    std::vector<int64_t> wide_keys(keys.begin(), keys.end());
+    std::vector<uint32_t> unsigned_keys(keys.begin(), keys.end());
+
+    InsertRouter router(MakeShards(std::vector<uint32_t>(64, 1)), "key", ShardingFunction::CityHash64);
+    // cityHash64() takes bytes of the value.
+    EXPECT_EQ(GetShards(router.Scatter(MakeBlock<ColumnInt32>(keys)), keys.size()),
+              GetShards(router.Scatter(MakeBlock<ColumnUInt32>(unsigned_keys)), keys.size()));
+
+    InsertRouter int_hash_router(MakeShards(std::vector<uint32_t>(64, 1)), "key", ShardingFunction::IntHash64);
+    // intHash64() converts the value to UInt64.
+    const auto shards = GetShards(int_hash_router.Scatter(MakeBlock<ColumnInt32>(keys)), keys.size());
+    EXPECT_EQ(shards, GetShards(int_hash_router.Scatter(MakeBlock<ColumnInt64>(wide_keys)), keys.size()));
+
+    // Both functions are the same for non-negative keys.
+    const auto city_shards = GetShards(router.Scatter(MakeBlock<ColumnInt32>(keys)), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (keys[i] >= 0) {
+            EXPECT_EQ(city_shards[i], shards[i]) << keys[i];
+        }
+    }
+}
+
+TEST(InsertRouterCase, Scatter_Strings) {
+    const std::vector<std::string> keys{"", "a", "foo", "bar", "some longer string to be hashed", "a"};
+
+    InsertRouter router(MakeShards({1, 1, 1}), "key");
+    const auto shards = GetShards(router.Scatter(MakeBlock<ColumnString>(keys)), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(CityHash64(keys[i].data(), keys[i].size()) % 3, shards[i]) << keys[i];
+    }
+
+    // LowCardinality column is split the same way.
+    Block block;
+    block.AppendColumn("row", std::make_shared<ColumnUInt64>(std::vector<uint64_t>{0, 1, 2, 3, 4, 5}));
+    block.AppendColumn("key", std::make_shared<ColumnLowCardinalityT<ColumnString>>(keys));
+    EXPECT_EQ(shards, GetShards(router.Scatter(block), keys.size()));
+}
+
+TEST(InsertRouterCase, Errors) {
+    EXPECT_THROW(InsertRouter(MakeShards({0, 0}), "key"), ValidationError);
+    EXPECT_THROW(InsertRouter({}, "key"), ValidationError);
+
+    InsertRouter router(MakeShards({1, 1}), "id");
+    // No key column.
+    EXPECT_THROW(router.Scatter(MakeBlock<ColumnUInt64>(std::vector<uint64_t>{1})), ValidationError);
+
+    InsertRouter float_router(MakeShards({1, 1}), "key");
+    EXPECT_THROW(float_router.Scatter(MakeBlock<ColumnFloat64>(std::vector<double>{1.5})), ValidationError);
+
+    InsertRouter identity_router(MakeShards({1, 1}), "key", ShardingFunction::Identity);
+    EXPECT_THROW(identity_router.Scatter(MakeBlock<ColumnString>(std::vector<std::string>{"a"})), ValidationError);
+}
+
+TEST(InsertRouterCase, Insert_ServerUnavailable) {
+    InsertRouter router(MakeShards({1, 1}), "key", ShardingFunction::Identity);
+    // Nothing listens on the port of shards.
+    EXPECT_THROW(router.Insert(MakeBlock<ColumnUInt64>(std::vector<uint64_t>{1, 2})), std::system_error);
+}
@@ -0,0 +1,327 @@
+#include "tcp_server.h"
+#include "utils.h"
+
+#include <clickhouse/client.h>
+#include <clickhouse/error_codes.h>
+#include <clickhouse/insert_spool.h>
+#include <clickhouse/native_format.h>
+#include <clickhouse/protocol.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/wire_format.h>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+using namespace clickhouse;
+
+namespace {
+
+std::string MakeSpoolDirectory(const std::string& name) {
+    const auto directory = testing::TempDir() + name;
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+}
+
+#if !defined(_win_)
+
+TEST(InsertSpoolCase, RecoverAndOverflow) {
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_recover");
+    // Nothing listens on the port, so blocks stay in the spool.
+    const auto client_options = ClientOptions()
+        .SetHost("localhost")
+        .SetPort(19983)
+        .SetRetryTimeout(std::chrono::seconds(0));
+    const auto options = InsertSpoolOptions()
+        .SetDirectory(directory)
+        .SetRetryInterval(std::chrono::minutes(1))
+        .SetSyncPolicy(SpoolSyncPolicy::EveryBlock);
+
+    size_t disk_usage = 0;
+    {
+        InsertSpool spool(client_options, options);
+        spool.Append("test_table", MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        spool.Append("test_table", MakeIdNameBlock({4, 5}, {"d", "e"}));
+        // Empty blocks are not stored.
+        spool.Append("test_table", Block());
+        disk_usage = spool.DiskUsage();
+        EXPECT_GT(disk_usage, 0u);
+        EXPECT_FALSE(spool.WaitUntilEmpty(std::chrono::milliseconds(10)));
+    }
+
+    // A record, which has been written partially, is dropped.
+    std::string last_segment;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        last_segment = std::max(last_segment, entry.path().string());
+    }
+    ASSERT_FALSE(last_segment.empty());
+    {
+        std::ofstream file(last_segment, std::ios::binary | std::ios::app);
+        file << "torn record";
+    }
+
+    {
+        InsertSpool spool(client_options, InsertSpoolOptions(options).SetMaxDiskUsage(disk_usage + 1));
+        EXPECT_EQ(disk_usage, spool.DiskUsage());
+        EXPECT_THROW(spool.Append("test_table", MakeIdNameBlock({6}, {"f"})), SpoolOverflowError);
+        EXPECT_EQ(disk_usage, spool.DiskUsage());
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(InsertSpoolCase, SealSegmentByAge) {
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_age");
+    // Nothing listens on the port, so blocks stay in the spool.
+    const auto client_options = ClientOptions()
+        .SetHost("localhost")
+        .SetPort(19983)
+        .SetRetryTimeout(std::chrono::seconds(0));
+    const auto options = InsertSpoolOptions()
+        .SetDirectory(directory)
+        .SetRetryInterval(std::chrono::minutes(1))
+        .SetMaxSegmentAge(std::chrono::milliseconds(200));
+
+    const auto count_segments = [&directory] {
+        const std::filesystem::directory_iterator it(directory);
+        return std::distance(begin(it), end(it));
+    };
+
+    {
+        InsertSpool spool(client_options, options);
+        // Blocks appended at a low rate are written into one segment.
+        for (uint64_t i = 0; i < 3; ++i) {
+            spool.Append("test_table", MakeIdNameBlock({i}, {"a"}));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        EXPECT_EQ(1, count_segments());
+
+        // The segment is completed, so the next block starts a new one.
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        spool.Append("test_table", MakeIdNameBlock({4}, {"b"}));
+        EXPECT_EQ(2, count_segments());
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(InsertSpoolCase, KeepCorruptedSegment) {
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_corrupted");
+    // Nothing listens on the port, but damaged blocks are not sent anyway.
+    const auto client_options = ClientOptions()
+        .SetHost("localhost")
+        .SetPort(19983)
+        .SetRetryTimeout(std::chrono::seconds(0));
+
+    std::vector<std::string> errors;
+    {
+        InsertSpool spool(
+            client_options,
+            InsertSpoolOptions()
+                .SetDirectory(directory)
+                .SetRetryInterval(std::chrono::minutes(1))
+                .SetMaxSegmentAge(std::chrono::milliseconds(200))
+                .SetErrorCallback([&errors](const std::string&, const Block&, const std::exception& e) {
+                    errors.push_back(e.what());
+                }));
+
+        spool.Append("test_table", MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        spool.Append("test_table", MakeIdNameBlock({4, 5}, {"d", "e"}));
+
+        // Damage name of the table in the first record, while the segment is being written.
+        const auto segment = std::filesystem::directory_iterator(directory)->path().string();
+        {
+            std::fstream file(segment, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(20);
+            file.put('?');
+        }
+
+        EXPECT_TRUE(spool.WaitUntilEmpty(std::chrono::seconds(10)));
+    }
+
+    ASSERT_EQ(1u, errors.size());
+    EXPECT_NE(std::string::npos, errors[0].find("checksum mismatch")) << errors[0];
+
+    // Segment is kept, but isn't loaded again.
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        files.push_back(entry.path().extension().string());
+    }
+    EXPECT_EQ(std::vector<std::string>{".corrupted"}, files);
+    {
+        InsertSpool spool(client_options, InsertSpoolOptions().SetDirectory(directory));
+        EXPECT_EQ(0u, spool.DiskUsage());
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(InsertSpoolCase, Replay) {
+    const int port = 19982;
+    LocalTcpServer server(port);
+    server.start();
+
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_replay");
+
+    std::string received;
+    std::thread fake_server([&server, &received] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        NativeFormatSettings settings;
+        settings.revision = 54465;
+
+        Buffer response;
+        {
+            BufferOutput output(&response);
+            WriteServerHello(output, settings.revision);
+
+            // Structure of the table and the end of query for each of two inserts.
+            for (int i = 0; i < 2; ++i) {
+                WireFormat::WriteUInt64(output, ServerCodes::Data);
+                WireFormat::WriteString(output, "");
+                WriteNativeBlock(output, settings, MakeIdNameBlock({}, {}));
+                WireFormat::WriteUInt64(output, ServerCodes::EndOfStream);
+            }
+            output.Flush();
+        }
+        received = RespondAndReceive(fd, response);
+    });
+
+    {
+        InsertSpool spool(
+            ClientOptions().SetHost("localhost").SetPort(port),
+            InsertSpoolOptions().SetDirectory(directory).SetCompressionMethod(CompressionMethod::LZ4));
+
+        spool.Append("first_table", MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        spool.Append("second_table", MakeIdNameBlock({4, 5}, {"d", "e"}));
+        EXPECT_TRUE(spool.WaitUntilEmpty(std::chrono::seconds(10)));
+        EXPECT_EQ(0u, spool.DiskUsage());
+    }
+    fake_server.join();
+
+    // Inserted segments are removed.
+    EXPECT_TRUE(std::filesystem::is_empty(directory));
+    std::filesystem::remove_all(directory);
+
+    const auto first = received.find("INSERT INTO first_table ( `id`,`name` ) VALUES");
+    const auto second = received.find("INSERT INTO second_table ( `id`,`name` ) VALUES");
+    ASSERT_NE(std::string::npos, first);
+    ASSERT_NE(std::string::npos, second);
+    EXPECT_LT(first, second);
+}
+
+TEST(InsertSpoolCase, RetryTemporaryServerError) {
+    const int port = 19984;
+    LocalTcpServer server(port);
+    server.start();
+
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_retry");
+
+    std::string received;
+    std::thread fake_server([&server, &received] {
+        NativeFormatSettings settings;
+        settings.revision = 54465;
+
+        // The first attempt fails with an error, which may pass.
+        {
+            const int fd = server.accept();
+            ASSERT_GE(fd, 0);
+
+            Buffer response;
+            BufferOutput output(&response);
+            WriteServerHello(output, settings.revision);
+            WireFormat::WriteUInt64(output, ServerCodes::Exception);
+            WireFormat::WriteFixed<int32_t>(output, ErrorCodes::MEMORY_LIMIT_EXCEEDED);
+            WireFormat::WriteString(output, "DB::Exception");
+            WireFormat::WriteString(output, "Memory limit (total) exceeded");
+            WireFormat::WriteString(output, "");
+            WireFormat::WriteFixed<uint8_t>(output, 0);
+            output.Flush();
+            RespondAndReceive(fd, response);
+        }
+
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        Buffer response;
+        BufferOutput output(&response);
+        WriteServerHello(output, settings.revision);
+        WireFormat::WriteUInt64(output, ServerCodes::Data);
+        WireFormat::WriteString(output, "");
+        WriteNativeBlock(output, settings, MakeIdNameBlock({}, {}));
+        WireFormat::WriteUInt64(output, ServerCodes::EndOfStream);
+        output.Flush();
+        received = RespondAndReceive(fd, response);
+    });
+
+    size_t errors = 0;
+    {
+        InsertSpool spool(
+            ClientOptions().SetHost("localhost").SetPort(port),
+            InsertSpoolOptions()
+                .SetDirectory(directory)
+                .SetRetryInterval(std::chrono::milliseconds(10))
+                .SetErrorCallback([&errors](const std::string&, const Block&, const std::exception&) { ++errors; }));
+
+        spool.Append("test_table", MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        EXPECT_TRUE(spool.WaitUntilEmpty(std::chrono::seconds(10)));
+    }
+    fake_server.join();
+    std::filesystem::remove_all(directory);
+
+    // Block is not dropped, but inserted with the next attempt.
+    EXPECT_EQ(0u, errors);
+    EXPECT_NE(std::string::npos, received.find("INSERT INTO test_table ( `id`,`name` ) VALUES"));
+}
+
+TEST(InsertSpoolCase, DropBlockOnProtocolError) {
+    const int port = 19988;
+    LocalTcpServer server(port);
+    server.start();
+
+    const auto directory = MakeSpoolDirectory("clickhouse_cpp_spool_client_error");
+
+    std::thread fake_server([&server] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        // Client doesn't know the packet, which the server answers to the query with.
+        Buffer response;
+        BufferOutput output(&response);
+        WriteServerHello(output, 54465);
+        WireFormat::WriteUInt64(output, 100);
+        output.Flush();
+        RespondAndReceive(fd, response);
+    });
+
+    std::vector<std::string> errors;
+    {
+        InsertSpool spool(
+            ClientOptions().SetHost("localhost").SetPort(port),
+            InsertSpoolOptions()
+                .SetDirectory(directory)
+                .SetRetryInterval(std::chrono::milliseconds(10))
+                .SetErrorCallback([&errors](const std::string& table_name, const Block& block, const std::exception& e) {
+                    EXPECT_EQ("test_table", table_name);
+                    EXPECT_EQ(3u, block.GetRowCount());
+                    errors.push_back(e.what());
+                }));
+
+        spool.Append("test_table", MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        // Block is dropped instead of being retried.
+        EXPECT_TRUE(spool.WaitUntilEmpty(std::chrono::seconds(10)));
+    }
+    fake_server.join();
+    std::filesystem::remove_all(directory);
+
+    ASSERT_EQ(1u, errors.size());
+    EXPECT_NE(std::string::npos, errors[0].find("unimplemented 100")) << errors[0];
+}
+
+#endif
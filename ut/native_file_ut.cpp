@@ -0,0 +1,281 @@
+#include "tcp_server.h"
+#include "utils.h"
+
+#include <clickhouse/client.h>
+#include <clickhouse/native_file.h>
+#include <clickhouse/native_format.h>
+#include <clickhouse/protocol.h>
+#include <clickhouse/base/compressed.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/wire_format.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using namespace clickhouse;
+
+namespace {
+
+/// Writes block in the form it is sent over the wire.
+void WriteWireBlock(OutputStream& output, const Block& block) {
+    // Block info: is_overflows, bucket_num.
+    WireFormat::WriteUInt64(output, 1);
+    WireFormat::WriteFixed<uint8_t>(output, 0);
+    WireFormat::WriteUInt64(output, 2);
+    WireFormat::WriteFixed<int32_t>(output, -1);
+    WireFormat::WriteUInt64(output, 0);
+
+    WireFormat::WriteUInt64(output, block.GetColumnCount());
+    WireFormat::WriteUInt64(output, block.GetRowCount());
+
+    for (Block::Iterator bi(block); bi.IsValid(); bi.Next()) {
+        WireFormat::WriteString(output, bi.Name());
+        WireFormat::WriteString(output, bi.Type()->GetName());
+        // No custom serialization.
+        WireFormat::WriteFixed<uint8_t>(output, 0);
+        if (block.GetRowCount()) {
+            bi.Column()->Save(&output);
+        }
+    }
+}
+
+Buffer CompressWireBlock(const Block& block) {
+    Buffer result;
+    BufferOutput buffer(&result);
+    BufferedOutput output(std::make_unique<CompressedOutput>(&buffer));
+    WriteWireBlock(output, block);
+    output.Flush();
+    return result;
+}
+
+/// Compresses block of the given revision, as the client does.
+Buffer CompressNativeBlock(const Block& block, uint64_t revision) {
+    NativeFormatSettings settings;
+    settings.revision = revision;
+
+    Buffer result;
+    BufferOutput buffer(&result);
+    BufferedOutput output(std::make_unique<CompressedOutput>(&buffer, 65535), 65535);
+    WriteNativeBlock(output, settings, block);
+    output.Flush();
+    return result;
+}
+
+Buffer ReadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return Buffer(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void ExpectBlock(const Block& block, const std::vector<uint64_t>& ids, const std::vector<std::string>& names) {
+    ASSERT_EQ(2u, block.GetColumnCount());
+    ASSERT_EQ(ids.size(), block.GetRowCount());
+    EXPECT_EQ("id", block.GetColumnName(0));
+    EXPECT_EQ("name", block.GetColumnName(1));
+    for (size_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(ids[i], block[0]->As<ColumnUInt64>()->At(i));
+        EXPECT_EQ(names[i], block[1]->As<ColumnString>()->At(i));
+    }
+}
+
+}
+
+TEST(NativeFileCase, WriteAndRead) {
+    const std::string path = testing::TempDir() + "clickhouse_cpp_native_file.bin";
+    {
+        NativeFileWriter writer(path);
+        writer.Write(MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+        writer.Write(MakeIdNameBlock({4, 5}, {"d", "e"}));
+        writer.Flush();
+    }
+
+    NativeFileReader reader(path);
+    for (int pass = 0; pass < 2; ++pass) {
+        Block block;
+        ASSERT_TRUE(reader.Next(&block));
+        ExpectBlock(block, {1, 2, 3}, {"a", "b", "c"});
+        ASSERT_TRUE(reader.Next(&block));
+        ExpectBlock(block, {4, 5}, {"d", "e"});
+        EXPECT_FALSE(reader.Next(&block));
+        reader.Rewind();
+    }
+    std::remove(path.c_str());
+}
+
+TEST(NativeFileCase, WriteAndRead_Compressed) {
+    const std::string path = testing::TempDir() + "clickhouse_cpp_native_file_lz4.bin";
+    const auto first = MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"});
+    const auto second = MakeIdNameBlock({4, 5}, {"d", "e"});
+    {
+        NativeFileWriter writer(path, CompressionMethod::LZ4);
+        writer.Write(first);
+        writer.Write(second);
+        writer.Flush();
+    }
+
+    // Blocks are written exactly as they are sent over the wire.
+    auto expected = CompressWireBlock(first);
+    const auto tail = CompressWireBlock(second);
+    expected.insert(expected.end(), tail.begin(), tail.end());
+    EXPECT_EQ(expected, ReadFile(path));
+
+    NativeFileReader reader(path, CompressionMethod::LZ4);
+    Block block;
+    ASSERT_TRUE(reader.Next(&block));
+    ExpectBlock(block, {1, 2, 3}, {"a", "b", "c"});
+    EXPECT_EQ(expected.size() - tail.size(), reader.Offset());
+    ASSERT_TRUE(reader.Next(&block));
+    ExpectBlock(block, {4, 5}, {"d", "e"});
+    EXPECT_FALSE(reader.Next(&block));
+    std::remove(path.c_str());
+}
+
+TEST(NativeFileCase, Read_Truncated) {
+    const std::string path = testing::TempDir() + "clickhouse_cpp_native_file_truncated.bin";
+    {
+        NativeFileWriter writer(path, CompressionMethod::LZ4);
+        writer.Write(MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}));
+    }
+    auto content = ReadFile(path);
+    content.resize(content.size() - 1);
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    }
+
+    NativeFileReader reader(path, CompressionMethod::LZ4);
+    Block block;
+    EXPECT_THROW(reader.Next(&block), ValidationError);
+    std::remove(path.c_str());
+}
+
+#if !defined(_win_)
+
+TEST(NativeFileCase, InsertNativeFile) {
+    const int port = 19981;
+    LocalTcpServer server(port);
+    server.start();
+
+    const std::string path = testing::TempDir() + "clickhouse_cpp_insert_native_file.bin";
+    const std::vector<Buffer> blocks{
+        CompressWireBlock(MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"})),
+        CompressWireBlock(MakeIdNameBlock({4, 5}, {"d", "e"}))
+    };
+    {
+        std::ofstream file(path, std::ios::binary);
+        for (const auto& frames : blocks) {
+            file.write(reinterpret_cast<const char*>(frames.data()), frames.size());
+        }
+    }
+
+    std::string received;
+    std::thread fake_server([&server, &received] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        Buffer response;
+        {
+            BufferOutput output(&response);
+            WriteServerHello(output, 54465);
+
+            // Client reads the following only when it expects them:
+            // the structure of the table, which asks for data, and the end of the query.
+            WireFormat::WriteUInt64(output, ServerCodes::Data);
+            WireFormat::WriteString(output, "");
+            const auto header = CompressWireBlock(MakeIdNameBlock({}, {}));
+            output.Write(header.data(), header.size());
+            WireFormat::WriteUInt64(output, ServerCodes::EndOfStream);
+            output.Flush();
+        }
+        received = RespondAndReceive(fd, response);
+    });
+
+    {
+        Client client(ClientOptions()
+            .SetHost("localhost")
+            .SetPort(port)
+            .SetCompressionMethod(CompressionMethod::LZ4));
+
+        client.InsertNativeFile("test_table", path);
+    }
+    fake_server.join();
+    std::remove(path.c_str());
+
+    EXPECT_NE(std::string::npos, received.find("INSERT INTO test_table ( `id`,`name` ) VALUES"));
+    // Each block of the file is sent as is in a data packet of its own.
+    for (const auto& frames : blocks) {
+        std::string packet;
+        packet.push_back(static_cast<char>(ClientCodes::Data));
+        // Name of the table is empty.
+        packet.push_back('\0');
+        packet.append(frames.begin(), frames.end());
+        EXPECT_NE(std::string::npos, received.find(packet));
+    }
+}
+
+TEST(NativeFileCase, InsertNativeFile_OldServer) {
+    const int port = 19986;
+    // Server doesn't know custom serialization of columns.
+    const uint64_t revision = 54453;
+    LocalTcpServer server(port);
+    server.start();
+
+    const std::string path = testing::TempDir() + "clickhouse_cpp_insert_native_file_old.bin";
+    const std::vector<Block> blocks{MakeIdNameBlock({1, 2, 3}, {"a", "b", "c"}), MakeIdNameBlock({4, 5}, {"d", "e"})};
+    {
+        NativeFileWriter writer(path, CompressionMethod::LZ4);
+        for (const auto& block : blocks) {
+            writer.Write(block);
+        }
+    }
+
+    std::string received;
+    std::thread fake_server([&server, &received, revision] {
+        const int fd = server.accept();
+        ASSERT_GE(fd, 0);
+
+        Buffer response;
+        {
+            BufferOutput output(&response);
+            WriteServerHello(output, revision);
+
+            WireFormat::WriteUInt64(output, ServerCodes::Data);
+            WireFormat::WriteString(output, "");
+            const auto header = CompressNativeBlock(MakeIdNameBlock({}, {}), revision);
+            output.Write(header.data(), header.size());
+            WireFormat::WriteUInt64(output, ServerCodes::EndOfStream);
+            output.Flush();
+        }
+        received = RespondAndReceive(fd, response);
+    });
+
+    {
+        Client client(ClientOptions()
+            .SetHost("localhost")
+            .SetPort(port)
+            .SetCompressionMethod(CompressionMethod::LZ4));
+
+        client.InsertNativeFile("test_table", path);
+    }
+    fake_server.join();
+    std::remove(path.c_str());
+
+    // Blocks are sent in the format of the server, not as they are in the file.
+    for (const auto& block : blocks) {
+        const auto frames = CompressNativeBlock(block, revision);
+        std::string packet;
+        packet.push_back(static_cast<char>(ClientCodes::Data));
+        packet.push_back('\0');
+        packet.append(frames.begin(), frames.end());
+        EXPECT_NE(std::string::npos, received.find(packet));
+
+        const auto file_frames = CompressWireBlock(block);
+        EXPECT_EQ(std::string::npos, received.find(std::string(file_frames.begin(), file_frames.end())));
+    }
+}
+
+#endif
@@ -9,6 +9,7 @@
 #include <clickhouse/client.h>
 #include <clickhouse/base/output.h>
 #include <clickhouse/base/input.h>
+#include <clickhouse/base/wire_format.h>
 
 #include <gtest/gtest.h>
 
@@ -253,6 +254,94 @@ TYPED_TEST_P(ColumnPerformanceTest, InsertAndSelect) {
     }
 }
 
+TEST(StringPerformanceTest, SaveToStream) {
+    SKIP_IN_DEBUG_BUILDS();
+    using Timer = Timer<std::chrono::microseconds>;
+
+    /// Discards data, as a socket with infinite bandwidth.
+    struct NullOutput : public OutputStream {
+        size_t DoWrite(const void*, size_t len) override {
+            return len;
+        }
+    };
+
+    const size_t ITEMS_COUNT = 10'000'000;
+    const int SAVE_REPEAT_TIMES = 5;
+
+    ColumnString column;
+    for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+        column.Append(generate(column, i));
+    }
+
+    std::cerr << "\n===========================================================" << std::endl;
+    std::cerr << "\t" << ITEMS_COUNT << " items of String saved to a socket-like stream" << std::endl;
+
+    auto measure = [&](auto save) {
+        Timer::DurationType total{0};
+        for (int i = 0; i < SAVE_REPEAT_TIMES; ++i) {
+            BufferedOutput output(std::make_unique<NullOutput>());
+
+            Timer timer;
+            save(output);
+            output.Flush();
+            total += timer.Elapsed();
+        }
+        return total / (SAVE_REPEAT_TIMES * 1.0);
+    };
+
+    std::cerr << "WriteString per item:\t" << measure([&](OutputStream& output) {
+        for (size_t i = 0; i < column.Size(); ++i) {
+            WireFormat::WriteString(output, column[i]);
+        }
+    }) << std::endl;
+
+    std::cerr << "SaveBody:\t" << measure([&](OutputStream& output) {
+        column.SaveBody(&output);
+    }) << std::endl;
+}
+
+TEST(LowCardinalityPerformanceTest, Append) {
+    SKIP_IN_DEBUG_BUILDS();
+    using Timer = Timer<std::chrono::microseconds>;
+
+    const size_t ITEMS_COUNT = 10'000'000;
+
+    for (size_t unique_items : {100, 10'000, 1'000'000}) {
+        std::vector<std::string> values;
+        values.reserve(ITEMS_COUNT);
+        for (size_t i = 0; i < ITEMS_COUNT; ++i) {
+            values.push_back("value_" + std::to_string((i * 2654435761u) % unique_items));
+        }
+
+        {
+            ColumnLowCardinalityT<ColumnString> column;
+
+            Timer timer;
+            for (const auto & value : values) {
+                column.Append(value);
+            }
+            const auto elapsed = timer.Elapsed();
+
+            EXPECT_EQ(ITEMS_COUNT, column.Size());
+            EXPECT_EQ(unique_items + 1, column.GetDictionarySize());
+            std::cerr << ITEMS_COUNT << " items, " << unique_items << " unique, appending:\t" << elapsed << std::endl;
+        }
+
+        {
+            const ColumnString strings(values);
+            ColumnLowCardinalityT<ColumnString> column;
+
+            Timer timer;
+            column.AppendFrom(strings);
+            const auto elapsed = timer.Elapsed();
+
+            EXPECT_EQ(ITEMS_COUNT, column.Size());
+            EXPECT_EQ(unique_items + 1, column.GetDictionarySize());
+            std::cerr << ITEMS_COUNT << " items, " << unique_items << " unique, AppendFrom:\t" << elapsed << std::endl;
+        }
+    }
+}
+
 REGISTER_TYPED_TEST_SUITE_P(ColumnPerformanceTest,
     SaveAndLoad, InsertAndSelect);
 
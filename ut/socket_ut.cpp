@@ -63,6 +63,53 @@ TEST(Socketcase, timeoutrecv) {
     server.stop();
 }
 
+TEST(Socketcase, waitForReadTimeout) {
+    int port = 19980;
+    NetworkAddress addr("localhost", std::to_string(port));
+    LocalTcpServer server(port);
+    server.start();
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    {
+        Socket socket(addr);
+
+        const auto start = std::chrono::steady_clock::now();
+        EXPECT_FALSE(socket.waitForRead(std::chrono::milliseconds(100)));
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    }
+
+    server.stop();
+}
+
+#if defined(__linux__)
+TEST(Socketcase, sendFileBeyondEnd) {
+    int port = 19987;
+    NetworkAddress addr("localhost", std::to_string(port));
+    LocalTcpServer server(port);
+    server.start();
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    {
+        FILE* file = tmpfile();
+        ASSERT_NE(nullptr, file);
+        ASSERT_EQ(4u, fwrite("data", 1, 4, file));
+        ASSERT_EQ(0, fflush(file));
+
+        Socket socket(addr);
+        try {
+            socket.sendFile(fileno(file), 0, 16);
+            FAIL();
+        } catch (const std::system_error& e) {
+            EXPECT_EQ(std::make_error_code(std::errc::io_error), e.code());
+            EXPECT_NE(nullptr, strstr(e.what(), "unexpected end of file"));
+        }
+        fclose(file);
+    }
+
+    server.stop();
+}
+#endif
+
 // Test to verify that reading from empty socket doesn't hangs.
 //TEST(Socketcase, ReadFromEmptySocket) {
 //    const int port = 12345;
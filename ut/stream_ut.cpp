@@ -1,9 +1,12 @@
+#include <clickhouse/base/compressed.h>
 #include <clickhouse/base/wire_format.h>
 #include <clickhouse/base/output.h>
 #include <clickhouse/base/input.h>
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+
 using namespace clickhouse;
 
 TEST(CodedStreamCase, Varint64) {
@@ -22,3 +25,78 @@ TEST(CodedStreamCase, Varint64) {
         ASSERT_EQ(value, 18446744071965638648ULL);
     }
 }
+
+TEST(CodedStreamCase, Peek) {
+    const std::string data = "abcdef";
+    BufferedInput input(std::make_unique<ArrayInput>(data.data(), data.size()), 4);
+
+    const void* ptr = nullptr;
+    ASSERT_EQ(4u, input.Peek(&ptr));
+    EXPECT_EQ(0, std::memcmp("abcd", ptr, 4));
+    // Peek does not consume data.
+    ASSERT_TRUE(input.Skip(3));
+    ASSERT_EQ(1u, input.Peek(&ptr));
+    EXPECT_EQ('d', *static_cast<const char*>(ptr));
+    ASSERT_TRUE(input.Skip(1));
+    ASSERT_EQ(2u, input.Peek(&ptr));
+    EXPECT_EQ(0, std::memcmp("ef", ptr, 2));
+}
+
+TEST(CodedStreamCase, BufferedOutputNext) {
+    Buffer buf;
+    BufferedOutput output(std::make_unique<BufferOutput>(&buf), 16);
+    output.Write("abcdefghij", 10);
+
+    // Rest of the buffer is taken without flushing it.
+    void* ptr = nullptr;
+    ASSERT_EQ(6u, output.Next(&ptr, 100));
+    EXPECT_TRUE(buf.empty());
+    std::memcpy(ptr, "klmnop", 6);
+
+    // The full buffer is flushed.
+    ASSERT_EQ(1u, output.Next(&ptr, 1));
+    EXPECT_EQ(16u, buf.size());
+    std::memcpy(ptr, "q", 1);
+    output.Flush();
+
+    EXPECT_EQ("abcdefghijklmnopq", std::string(buf.begin(), buf.end()));
+}
+
+TEST(CompressedStreamCase, RawFrames) {
+    std::string data(100000, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>(i % 61);
+    }
+
+    Buffer compressed;
+    {
+        BufferOutput buffer(&compressed);
+        CompressedOutput output(&buffer, 30000);
+        output.Write(data.data(), data.size());
+        output.Flush();
+    }
+
+    CompressedFrames raw;
+    std::string decompressed(data.size(), '\0');
+    {
+        ArrayInput array(compressed.data(), compressed.size());
+        CompressedInput input(&array, &raw);
+        ASSERT_TRUE(WireFormat::ReadBytes(input, decompressed.data(), decompressed.size()));
+    }
+
+    EXPECT_EQ(data, decompressed);
+    // Frames are kept exactly as they have been read.
+    EXPECT_EQ(compressed, raw.data);
+
+    ASSERT_EQ(4u, raw.headers.size());
+    size_t offset = 0;
+    size_t original = 0;
+    for (const auto& header : raw.headers) {
+        EXPECT_EQ(offset, header.offset);
+        EXPECT_EQ(0x82, header.method);
+        offset += 16 + header.compressed_size;
+        original += header.original_size;
+    }
+    EXPECT_EQ(compressed.size(), offset);
+    EXPECT_EQ(data.size(), original);
+}
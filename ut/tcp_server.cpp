@@ -1,5 +1,11 @@
 #include "tcp_server.h"
 
+#include <clickhouse/protocol.h>
+#include <clickhouse/revision.h>
+#include <clickhouse/base/output.h>
+#include <clickhouse/base/socket.h>
+#include <clickhouse/base/wire_format.h>
+
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -61,6 +67,10 @@ void LocalTcpServer::start() {
     listen(serverSd_, 3);
 }
 
+int LocalTcpServer::accept() {
+    return static_cast<int>(::accept(serverSd_, nullptr, nullptr));
+}
+
 void LocalTcpServer::stop() {
     if(serverSd_ > 0) {
 
@@ -75,4 +85,41 @@ void LocalTcpServer::stop() {
     }
 }
 
+void WriteServerHello(OutputStream& output, uint64_t revision) {
+    WireFormat::WriteUInt64(output, ServerCodes::Hello);
+    WireFormat::WriteString(output, "ClickHouse");
+    WireFormat::WriteUInt64(output, 23);
+    WireFormat::WriteUInt64(output, 8);
+    WireFormat::WriteUInt64(output, revision);
+    WireFormat::WriteString(output, "UTC");
+    WireFormat::WriteString(output, "fake");
+    WireFormat::WriteUInt64(output, 1);
+    if (revision >= DBMS_MIN_REVISION_WITH_PASSWORD_COMPLEXITY_RULES) {
+        // No password complexity rules.
+        WireFormat::WriteUInt64(output, 0);
+    }
+    if (revision >= DBMS_MIN_REVISION_WITH_INTERSERVER_SECRET_V2) {
+        // Nonce.
+        WireFormat::WriteFixed<uint64_t>(output, 0);
+    }
+}
+
+std::string RespondAndReceive(int fd, const Buffer& response) {
+    SocketOutput(fd).Write(response.data(), response.size());
+
+    std::string received;
+    char buffer[4096];
+    int ret;
+    while ((ret = static_cast<int>(::recv(fd, buffer, sizeof(buffer), 0))) > 0) {
+        received.append(buffer, static_cast<size_t>(ret));
+    }
+
+#if defined(__WIN32__) || defined(_WIN32) || defined(_WIN64)
+    closesocket(fd);
+#else
+    close(fd);
+#endif
+    return received;
+}
+
 }
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <clickhouse/base/buffer.h>
+
+#include <cstdint>
 #include <memory>
+#include <string>
 
 namespace clickhouse {
 
@@ -15,10 +19,19 @@ public:
     void start();
     void stop();
 
+    /// Waits for an incoming connection and returns its descriptor.
+    int accept();
+
 private:
 
     int port_;
     int serverSd_;
 };
 
+/// Writes Hello packet, with which a fake server of the given revision answers the client.
+void WriteServerHello(OutputStream& output, uint64_t revision);
+
+/// Sends the response to the client and returns everything it sends until it disconnects.
+std::string RespondAndReceive(int fd, const Buffer& response);
+
 }
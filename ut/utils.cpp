@@ -326,3 +326,10 @@ std::string ToString(const clickhouse::UUID& v) {
     }
     return result;
 }
+
+Block MakeIdNameBlock(std::vector<uint64_t> ids, std::vector<std::string> names) {
+    Block block;
+    block.AppendColumn("id", std::make_shared<ColumnUInt64>(std::move(ids)));
+    block.AppendColumn("name", std::make_shared<ColumnString>(std::move(names)));
+    return block;
+}
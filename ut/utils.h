@@ -186,3 +186,6 @@ inline uint64_t versionNumber(
 uint64_t versionNumber(const clickhouse::ServerInfo & server_info);
 
 std::string ToString(const clickhouse::UUID& v);
+
+/// Block of columns `id` UInt64 and `name` String.
+clickhouse::Block MakeIdNameBlock(std::vector<uint64_t> ids, std::vector<std::string> names);